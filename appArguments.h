@@ -4,13 +4,19 @@
 
 #ifndef APP_ARGUMENTS_H
 #define APP_ARGUMENTS_H
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <map>
+#include <stdexcept>
 #include <utility>
 #include <variant>
+#include <vector>
 #include <optional>
+#include "appExceptions.h"
 
 namespace app::arguments {
+    enum class ConvResult; // see appNumeric.h
     enum class ValueType {
         None = 0,
         String,
@@ -19,15 +25,121 @@ namespace app::arguments {
         Int64,
         Int64h, // hex 64-bit integer
         Float,
+        // lists collect repeated options and split comma separated values
+        StringList,
+        Int32List,
+        Int32hList,
+        Int64List,
+        Int64hList,
+        FloatList,
+        Enum, // one of Options::enumNames, the value is the int32_t name index
     };
+    /**
+     * tests for a list value type
+     * @param valueType value type
+     * @return true for the list value types
+     */
+    constexpr bool isList(ValueType valueType) noexcept {
+        return valueType >= ValueType::StringList && valueType <= ValueType::FloatList;
+    }
+    /**
+     * returns the list element type
+     * @param valueType list value type
+     * @return element value type, the value type itself for scalar types
+     */
+    constexpr ValueType elementType(ValueType valueType) noexcept {
+        return isList(valueType) ? static_cast<ValueType>(static_cast<int>(valueType) - static_cast<int>(ValueType::StringList) +
+            static_cast<int>(ValueType::String)) : valueType;
+    }
 
-    typedef std::variant<std::string, int32_t, int64_t, double, bool> Value;
+    /**
+     * string value borrowed from the parsed arguments, see StringMode::Borrow.
+     * The constructor is explicit, so C-strings still select std::string in Value
+     */
+    class BorrowedString : public std::string_view {
+    public:
+        constexpr BorrowedString() noexcept : std::string_view() {};
+        constexpr explicit BorrowedString(std::string_view view) noexcept : std::string_view(view) {};
+    };
+    /**
+     * list of strings stored in one buffer, the elements are '\0' separated so each of them is a C-string too
+     */
+    class StringList {
+    public:
+        StringList() : blob(), ends() {};
+        [[nodiscard]] size_t size() const noexcept { return ends.size(); }
+        [[nodiscard]] bool empty() const noexcept { return ends.empty(); }
+        [[nodiscard]] std::string_view operator[](size_t idx) const noexcept {
+            const size_t begin = idx == 0 ? 0 : ends[idx - 1] + 1;
+            return std::string_view(blob.data() + begin, ends[idx] - begin);
+        }
+        [[nodiscard]] const char* c_str(size_t idx) const noexcept { return blob.data() + (idx == 0 ? 0 : ends[idx - 1] + 1); }
+        [[nodiscard]] std::string_view buffer() const noexcept { return blob; } // all the elements with their '\0'
+        void reserve(size_t count, size_t bytes) {
+            ends.reserve(ends.size() + count);
+            blob.reserve(blob.size() + bytes + count);
+        }
+        void push_back(std::string_view str) {
+            blob.append(str);
+            ends.push_back(static_cast<uint32_t>(blob.size()));
+            blob.push_back('\0');
+        }
+        bool operator==(const StringList& other) const noexcept { return ends == other.ends && blob == other.blob; }
+        bool operator!=(const StringList& other) const noexcept { return !(*this == other); }
+    private:
+        std::string blob; // elements followed by '\0'
+        std::vector<uint32_t> ends; // element end offsets in the blob
+    };
+    typedef std::variant<std::string, int32_t, int64_t, double, bool, BorrowedString,
+        std::vector<int32_t>, std::vector<int64_t>, std::vector<double>, StringList> Value;
     typedef std::optional<Value> DefaultValue;
+    /**
+     * the way string values are stored
+     */
+    enum class StringMode {
+        Copy = 0, // values are copied into std::string
+        Borrow, // values are BorrowedString views into the parsed arguments (argv or a caller-owned buffer) or into the option default value
+        Arena, // values are copied into the parse context memory resource and stored as BorrowedString, defaults are borrowed
+    };
+    /**
+     * compares value types, std::string and BorrowedString are the same type
+     * @param l the first value
+     * @param r the second value
+     * @return true when both values hold the same type
+     */
+    inline bool isSameType(const Value& l, const Value& r) noexcept {
+        auto kind = [](const Value& v) { return v.index() == 5 ? 0 : v.index(); };
+        return kind(l) == kind(r);
+    }
     enum class Type {
         None = 0,
         Optional,
         Mandatory,
     };
+    /**
+     * a number out of Options::minValue..Options::maxValue. Unlike other conversion failures it is reported
+     * for optional options too
+     */
+    class RangeError : public std::invalid_argument {
+    public:
+        explicit RangeError(const char* what) : std::invalid_argument(what) {};
+    };
+    /**
+     * perfect hash of enumeration names: every name has its own slot, so a lookup hashes the string once and
+     * compares it with one name
+     */
+    class EnumIndex {
+    public:
+        EnumIndex() : seed(0), mask(0), slots() {};
+        void build(const std::vector<std::string>& names);
+        [[nodiscard]] bool empty() const noexcept { return slots.empty(); }
+        [[nodiscard]] int32_t find(std::string_view name, const std::vector<std::string>& names) const noexcept;
+        static uint32_t hash(std::string_view name, uint32_t seed) noexcept;
+    private:
+        uint32_t seed;
+        uint32_t mask; // slots count - 1
+        std::vector<int32_t> slots; // name index by hash slot, -1 for an empty slot
+    };
     class Options {
     public:
         std::string name;
@@ -36,16 +148,32 @@ namespace app::arguments {
         char shortCut;
         ValueType valueType;
         DefaultValue defaultValue;
+        std::string envName; // environment variable providing the value, empty when there is no such variable
+        std::string shortUtf8; // multi-byte UTF-8 short option used instead of shortCut, e.g. "\xce\xbb"
+        DefaultValue minValue; // the least numeric value or list element allowed, no limit when empty
+        DefaultValue maxValue; // the greatest numeric value or list element allowed, no limit when empty
+        std::vector<std::string> enumNames; // ValueType::Enum names
+        EnumIndex enumIndex; // enumNames perfect hash, built with the schema
         Options(const char sc, std::string name, std::string  descr, const Type mandatory, const ValueType valType, DefaultValue dv) :
-            name(std::move(name)), type(mandatory), desc(std::move(descr)), shortCut(sc), valueType(valType), defaultValue(std::move(dv)) {
+            name(std::move(name)), type(mandatory), desc(std::move(descr)), shortCut(sc), valueType(valType), defaultValue(std::move(dv)),
+            envName(), shortUtf8(), minValue(), maxValue(), enumNames(), enumIndex() {
         };
         Options(const char sc, std::string name, std::string  descr, const Type mandatory, const ValueType valType) :
-            name(std::move(name)), type(mandatory),desc(std::move(descr)), shortCut(sc), valueType(valType), defaultValue() {};
+            name(std::move(name)), type(mandatory),desc(std::move(descr)), shortCut(sc), valueType(valType), defaultValue(), envName(), shortUtf8(),
+            minValue(), maxValue(), enumNames(), enumIndex() {};
         Options(const char sc, std::string name, std::string  descr) :
-            name(std::move(name)), type(Type::None),desc(std::move(descr)), shortCut(sc), valueType(ValueType::None), defaultValue() {};
-        Value acquireValue(const char* pVal) const;
+            name(std::move(name)), type(Type::None),desc(std::move(descr)), shortCut(sc), valueType(ValueType::None), defaultValue(),
+            envName(), shortUtf8(), minValue(), maxValue(), enumNames(), enumIndex() {};
+        Options(const char sc, std::string name, std::string  descr, const Type mandatory, std::vector<std::string> names, DefaultValue dv = DefaultValue());
+        Value acquireValue(const char* pVal, StringMode mode = StringMode::Copy) const;
+        void appendValue(const char* pVal, Value& list) const;
+        ConvResult tryAcquireValue(const char* pVal, StringMode mode, Value& val) const;
+        ConvResult tryAppendValue(const char* pVal, Value& list) const;
+        [[nodiscard]] Value acquireDefault(StringMode mode) const;
+        [[nodiscard]] int32_t findEnum(std::string_view str) const noexcept;
     };
     typedef std::map<std::string, Options> OptionsMap;
+    void mapEnvironment(std::vector<Options>& optMap, std::string_view prefix);
 }
 
 #endif //APP_ARGUMENTS_H
\ No newline at end of file
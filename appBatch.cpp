@@ -0,0 +1,257 @@
+//
+// Created by shtykov on 10/18/26.
+//
+#include "appBatch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include "appResponseFile.h"
+using namespace app::config;
+
+namespace {
+    const size_t CHUNK_LINES = 256; // lines parsed by a worker at once
+
+    /**
+     * an explicitly passed value of a line
+     */
+    class Cell {
+    public:
+        uint32_t option;
+        uint32_t line;
+        app::arguments::Value value;
+    };
+
+    /**
+     * [begin, end) range of chunks owned by a worker, packed into one word so that the owner and thieves
+     * update it with a single compare-and-swap
+     */
+    class alignas(64) WorkRange {
+    public:
+        std::atomic<uint64_t> range;
+        WorkRange() : range(0) {};
+    };
+
+    inline uint64_t pack(uint32_t begin, uint32_t end) {
+        return (static_cast<uint64_t>(begin) << 32) | end;
+    }
+
+    /**
+     * takes the first chunk of the own range
+     * @param work own range
+     * @param chunk receives the chunk index
+     * @return false when the range is empty
+     */
+    bool popFront(WorkRange& work, uint32_t& chunk) {
+        uint64_t cur = work.range.load(std::memory_order_acquire);
+        while (true) {
+            const uint32_t begin = static_cast<uint32_t>(cur >> 32);
+            const uint32_t end = static_cast<uint32_t>(cur);
+            if (begin >= end) {
+                return false;
+            }
+            if (work.range.compare_exchange_weak(cur, pack(begin + 1, end), std::memory_order_acq_rel)) {
+                chunk = begin;
+                return true;
+            }
+        }
+    }
+
+    /**
+     * steals the upper half of another worker range
+     * @param victim the other worker range
+     * @param begin receives the stolen range begin
+     * @param end receives the stolen range end
+     * @return false when there is nothing to steal
+     */
+    bool stealHalf(WorkRange& victim, uint32_t& begin, uint32_t& end) {
+        uint64_t cur = victim.range.load(std::memory_order_acquire);
+        while (true) {
+            const uint32_t vBegin = static_cast<uint32_t>(cur >> 32);
+            const uint32_t vEnd = static_cast<uint32_t>(cur);
+            if (vBegin >= vEnd) {
+                return false;
+            }
+            const uint32_t mid = vEnd - (vEnd - vBegin + 1) / 2;
+            if (victim.range.compare_exchange_weak(cur, pack(vBegin, mid), std::memory_order_acq_rel)) {
+                begin = mid;
+                end = vEnd;
+                return true;
+            }
+        }
+    }
+}
+
+/**
+ * returns the value of the line: explicitly passed value or the mandatory option default
+ * @param opt option handle of the parsed schema
+ * @param line line number
+ * @return pointer to the value or nullptr when there is no value
+ */
+const app::arguments::Value* BatchResult::find(const app::arguments::OptionHandle opt, size_t line) const noexcept {
+    if (pSchema == nullptr || opt.index >= columns.size()) {
+        return nullptr;
+    }
+    const auto& col = columns[opt.index];
+    auto it = std::lower_bound(col.lines.begin(), col.lines.end(), static_cast<uint32_t>(line));
+    if (it != col.lines.end() && *it == line) {
+        return &col.values[it - col.lines.begin()];
+    }
+    const auto& rOpt = (*pSchema)[opt.index];
+    if (rOpt.type == app::arguments::Type::Mandatory && rOpt.defaultValue.has_value()) {
+        return &rOpt.defaultValue.value();
+    }
+    return nullptr;
+}
+
+/**
+ * @param schema compiled options to parse command lines, it must outlive the parser and its results
+ * @param threads worker threads, 0 for the hardware concurrency
+ */
+BatchParser::BatchParser(const app::arguments::ParserSchema& schema, const unsigned threads) :
+    schema(schema), threads(threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency())) {
+}
+
+/**
+ * parses command lines
+ * @param sets command lines
+ * @param count command lines count
+ * @param result receives the results
+ */
+void BatchParser::parse(const ArgvSet* sets, size_t count, BatchResult& result) {
+    result.file.close();
+    run(count, [this, sets](ParseContext& ctx, size_t line, std::vector<char*>&) {
+        return ctx.parseArgs(sets[line].argc, sets[line].argv, schema);
+    }, result);
+}
+
+/**
+ * parses newline-delimited command lines file, each line is a command line starting with the program name.
+ * Lines are split into arguments in place with the response files rules
+ * @param path command lines file
+ * @param result receives the results, the file mapping is kept there
+ * @return false when the file cannot be read
+ */
+bool BatchParser::parseFile(const std::string& path, BatchResult& result) {
+    if (!result.file.open(path)) {
+        return false;
+    }
+    char* const pData = result.file.data();
+    char* const pEnd = pData + result.file.size();
+    std::vector<char*> lines;
+    for (char* p = pData; p < pEnd; ) {
+        lines.push_back(p);
+        char* pEol = static_cast<char*>(::memchr(p, '\n', pEnd - p));
+        p = pEol != nullptr ? pEol + 1 : pEnd;
+    }
+    lines.push_back(pEnd + 1);
+    run(lines.size() - 1, [this, &lines](ParseContext& ctx, size_t line, std::vector<char*>& args) {
+        char* p = lines[line];
+        char* const pLineEnd = lines[line + 1] - 1; // '\n' or the mapping terminator
+        bool bUnterminated = false;
+        args.clear();
+        while (char* pArg = nextArgument(p, pLineEnd, bUnterminated)) {
+            args.push_back(pArg);
+        }
+        if (bUnterminated) {
+            ctx.reset(schema);
+            ctx.badArgumentIndex = args.size();
+            ctx.badArgumentOffset = 0;
+            return ParseResult::Error;
+        }
+        args.push_back(nullptr);
+        return ctx.parseArgs(static_cast<int>(args.size() - 1), args.data(), schema);
+    }, result);
+    return true;
+}
+
+/**
+ * parses lines on the thread pool and collects the results into columns
+ * @param count lines count
+ * @param parseLine parses one line with the worker context
+ * @param result receives the results
+ */
+void BatchParser::run(size_t count, const LineParser& parseLine, BatchResult& result) {
+    const size_t options = schema.size();
+    result.pSchema = &schema;
+    result.results.assign(count, ParseResult::None);
+    result.badIndex.assign(count, 0);
+    result.badOffset.assign(count, 0);
+    result.columns.assign(options, BatchResult::Column());
+    const size_t chunks = (count + CHUNK_LINES - 1) / CHUNK_LINES;
+    const size_t workers = std::max<size_t>(1, std::min<size_t>(threads, chunks));
+    std::vector<std::vector<Cell>> cells(chunks);
+    std::vector<WorkRange> ranges(workers);
+    for (size_t w = 0; w < workers; w++) {
+        ranges[w].range.store(pack(static_cast<uint32_t>(chunks * w / workers), static_cast<uint32_t>(chunks * (w + 1) / workers)));
+    }
+    auto worker = [&](size_t w) {
+        ParseContext ctx;
+        ctx.setStringMode(app::arguments::StringMode::Borrow);
+        std::vector<char*> args;
+        while (true) {
+            uint32_t chunk = 0;
+            if (!popFront(ranges[w], chunk)) {
+                bool bStolen = false;
+                for (size_t k = 1; k < workers && !bStolen; k++) {
+                    uint32_t begin = 0;
+                    uint32_t end = 0;
+                    if (stealHalf(ranges[(w + k) % workers], begin, end)) {
+                        ranges[w].range.store(pack(begin, end), std::memory_order_release);
+                        bStolen = true;
+                    }
+                }
+                if (!bStolen) {
+                    break;
+                }
+                continue;
+            }
+            auto& chunkCells = cells[chunk];
+            const size_t last = std::min(count, (chunk + 1) * CHUNK_LINES);
+            for (size_t line = chunk * CHUNK_LINES; line < last; line++) {
+                result.results[line] = parseLine(ctx, line, args);
+                result.badIndex[line] = static_cast<uint32_t>(ctx.badArgumentIndex);
+                result.badOffset[line] = static_cast<uint32_t>(ctx.badArgumentOffset);
+                if (result.results[line] != ParseResult::Parsed) {
+                    continue; // a rejected line has no cells, even for the options parsed before the bad argument
+                }
+                const auto& assigned = ctx.assignedMask();
+                for (size_t word = 0; word < assigned.size(); word++) {
+                    for (app::arguments::MaskWord bits = assigned[word]; bits != 0; bits &= bits - 1) {
+                        const size_t idx = word * app::arguments::MASK_WORD_BITS + app::arguments::lowestBit(bits);
+                        chunkCells.push_back({ static_cast<uint32_t>(idx), static_cast<uint32_t>(line),
+                            ctx.getValue(app::arguments::OptionHandle(idx)) });
+                    }
+                }
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (size_t w = 1; w < workers; w++) {
+        pool.emplace_back(worker, w);
+    }
+    worker(0);
+    for (auto& th : pool) {
+        th.join();
+    }
+    // chunks are in line order, so the columns are sorted by line
+    std::vector<size_t> sizes(options, 0);
+    for (const auto& chunkCells : cells) {
+        for (const auto& cell : chunkCells) {
+            sizes[cell.option] ++;
+        }
+    }
+    for (size_t i = 0; i < options; i++) {
+        result.columns[i].lines.reserve(sizes[i]);
+        result.columns[i].values.reserve(sizes[i]);
+    }
+    for (auto& chunkCells : cells) {
+        for (auto& cell : chunkCells) {
+            auto& col = result.columns[cell.option];
+            col.lines.push_back(cell.line);
+            col.values.push_back(std::move(cell.value));
+        }
+        std::vector<Cell>().swap(chunkCells);
+    }
+}
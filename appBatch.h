@@ -0,0 +1,71 @@
+//
+// Created by shtykov on 10/18/26.
+//
+
+#ifndef APP_BATCH_H
+#define APP_BATCH_H
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "appConfig.h"
+#include "appMappedFile.h"
+
+namespace app::config {
+    /**
+     * one recorded command line
+     */
+    class ArgvSet {
+    public:
+        int argc;
+        char** argv;
+    };
+
+    /**
+     * results of a batch parse. Explicitly passed values are stored by option in columns sorted by line,
+     * defaults are not repeated per line and a line which failed to parse has no values
+     */
+    class BatchResult {
+    public:
+        class Column {
+        public:
+            std::vector<uint32_t> lines; // ascending line numbers
+            std::vector<app::arguments::Value> values; // values of the lines
+        };
+        BatchResult() : pSchema(nullptr), results(), badIndex(), badOffset(), columns(), file() {};
+        [[nodiscard]] size_t size() const noexcept { return results.size(); }
+        [[nodiscard]] ParseResult result(size_t line) const { return results[line]; }
+        [[nodiscard]] size_t badArgumentIndex(size_t line) const { return badIndex[line]; }
+        [[nodiscard]] size_t badArgumentOffset(size_t line) const { return badOffset[line]; }
+        [[nodiscard]] const Column& column(app::arguments::OptionHandle opt) const { return columns[opt.index]; }
+        [[nodiscard]] const app::arguments::Value* find(app::arguments::OptionHandle opt, size_t line) const noexcept;
+    private:
+        friend class BatchParser;
+        const app::arguments::ParserSchema* pSchema;
+        std::vector<ParseResult> results;
+        std::vector<uint32_t> badIndex;
+        std::vector<uint32_t> badOffset;
+        std::vector<Column> columns;
+        MappedFile file; // parsed lines file, borrowed strings point into it
+    };
+
+    /**
+     * parses many command lines against the same schema on a work-stealing thread pool. Each worker owns
+     * a range of line chunks and steals half of the remaining range of another worker when its own range is over.
+     * String values are borrowed: argv sets must outlive the results
+     */
+    class BatchParser {
+    public:
+        explicit BatchParser(const app::arguments::ParserSchema& schema, unsigned threads = 0);
+        void parse(const ArgvSet* sets, size_t count, BatchResult& result);
+        bool parseFile(const std::string& path, BatchResult& result);
+    private:
+        typedef std::function<ParseResult(ParseContext&, size_t, std::vector<char*>&)> LineParser;
+        const app::arguments::ParserSchema& schema;
+        unsigned threads;
+        void run(size_t count, const LineParser& parseLine, BatchResult& result);
+    };
+}
+
+#endif //APP_BATCH_H
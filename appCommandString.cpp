@@ -0,0 +1,162 @@
+//
+// Created by shtykov on 10/18/26.
+//
+#include "appCommandString.h"
+
+#include <cstring>
+#include "appResponseFile.h"
+#include "appStats.h"
+using namespace app::config;
+
+static inline bool isSpace(const char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline bool isDoubleQuoteEscape(const char c) {
+    return c == '$' || c == '`' || c == '"' || c == '\\' || c == '\n';
+}
+
+/**
+ * skips white space, joined lines and comments before the next word
+ * @param p scan position
+ * @param pEnd scan end
+ * @return the word start or pEnd
+ */
+static char* skipSeparators(char* p, char* const pEnd) {
+    while (p < pEnd) {
+        if (isSpace(*p)) {
+            p ++;
+        }
+        else if (*p == '\\' && p + 1 < pEnd && p[1] == '\n') {
+            p += 2;
+        }
+        else if (*p == '#') {
+            auto* pEol = static_cast<char*>(std::memchr(p, '\n', pEnd - p));
+            p = pEol != nullptr ? pEol : pEnd;
+        }
+        else {
+            break;
+        }
+    }
+    return p;
+}
+
+/**
+ * splits the next word in place, quotes and escapes are removed by moving the rest of the word left.
+ * The word is terminated with '\0' written over the separator, so *pEnd must be writable
+ * @param p scan position, receives the position after the word
+ * @param pEnd scan end
+ * @param pOpenQuote receives the unclosed quote position or nullptr
+ * @return the word or nullptr when there are no more words or a quote is not closed
+ */
+static char* nextWord(char*& p, char* const pEnd, char*& pOpenQuote) noexcept {
+    pOpenQuote = nullptr;
+    p = skipSeparators(p, pEnd);
+    if (p >= pEnd) {
+        return nullptr;
+    }
+    char* const pWord = p;
+    // fast path: plain words are only terminated, control characters other than spaces are plain ones
+    p = findArgumentBreak(p, pEnd);
+    while (p < pEnd && static_cast<unsigned char>(*p) < ' ' && !isSpace(*p)) {
+        p = findArgumentBreak(p + 1, pEnd);
+    }
+    char* pOut = p;
+    while (p < pEnd) {
+        const char c = *p;
+        if (c == '\'') {
+            auto* pClose = static_cast<char*>(std::memchr(p + 1, '\'', pEnd - p - 1));
+            if (pClose == nullptr) {
+                pOpenQuote = p;
+                return nullptr;
+            }
+            const size_t len = pClose - p - 1;
+            std::memmove(pOut, p + 1, len);
+            pOut += len;
+            p = pClose + 1;
+            continue;
+        }
+        if (c == '"') {
+            char* const pOpen = p;
+            for (p ++; p < pEnd && *p != '"'; p ++) {
+                if (*p == '\\' && p + 1 < pEnd && isDoubleQuoteEscape(p[1])) {
+                    if (*++p == '\n') {
+                        continue; // joined lines
+                    }
+                }
+                *pOut++ = *p;
+            }
+            if (p >= pEnd) {
+                pOpenQuote = pOpen;
+                return nullptr;
+            }
+            p ++;
+            continue;
+        }
+        if (isSpace(c)) {
+            break;
+        }
+        if (c == '\\' && p + 1 < pEnd) {
+            if (p[1] != '\n') { // a backslash before a newline joins the lines
+                *pOut++ = p[1];
+            }
+            p += 2;
+            continue;
+        }
+        // a plain run up to the next quote, backslash or space is moved at once
+        char* const pRun = findArgumentBreak(p + 1, pEnd);
+        std::memmove(pOut, p, pRun - p);
+        pOut += pRun - p;
+        p = pRun;
+    }
+    *pOut = '\0';
+    if (p < pEnd) {
+        p ++;
+    }
+    return pWord;
+}
+
+/**
+ * splits the command line in place, the byte after the string is overwritten with '\0', so
+ * pCommand[size] must be writable (as it is in std::string)
+ * @param pCommand command line
+ * @param size command line length
+ * @param pProgram argv[0] when the string holds the arguments only, nullptr when its first word is the program
+ * @return split result, badArgumentIndex and badArgumentOffset locate the unclosed quote
+ */
+CommandString::Result CommandString::split(char* pCommand, size_t size, const char* pProgram) {
+    APP_STATS_PHASE(Tokenize);
+    args.clear();
+    badArgumentIndex = badArgumentOffset = 0;
+    pBase = pCommand;
+    firstWord = pProgram != nullptr ? 1 : 0;
+    if (pProgram != nullptr) {
+        args.push_back(const_cast<char*>(pProgram));
+    }
+    char* p = pCommand;
+    char* const pEnd = pCommand + size;
+    char* pOpenQuote = nullptr;
+    while (char* pArg = nextWord(p, pEnd, pOpenQuote)) {
+        args.push_back(pArg);
+    }
+    if (pOpenQuote != nullptr) {
+        badArgumentIndex = args.size();
+        badArgumentOffset = pOpenQuote - pCommand;
+        args.clear();
+        return Result::Unterminated;
+    }
+    args.push_back(nullptr);
+    return Result::Split;
+}
+
+/**
+ * returns where the argument starts in the command string, e.g. to point at a parse error
+ * @param index argument index
+ * @return byte offset in the command string or std::string::npos for argv[0] passed to split()
+ */
+size_t CommandString::offsetOf(size_t index) const noexcept {
+    if (index < firstWord || index + 1 >= args.size()) {
+        return std::string::npos;
+    }
+    return static_cast<size_t>(args[index] - pBase);
+}
@@ -0,0 +1,58 @@
+//
+// Created by shtykov on 10/18/26.
+//
+
+#ifndef APP_COMMAND_STRING_H
+#define APP_COMMAND_STRING_H
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace app::config {
+    /**
+     * splits a command line given as one string into argv with POSIX shell quoting: words are separated by
+     * white space, single quotes keep everything up to the closing quote, double quotes group white space and
+     * a backslash in them escapes only $ ` " \ and a newline, an unquoted backslash escapes the next character,
+     * a backslash before a newline joins the lines and '#' starting a word comments the rest of the line.
+     * There are no expansions. The string is split in place and the argv storage is reused by the next split,
+     * so a split makes no allocation per argument; the string must outlive the parsed values in StringMode::Borrow.
+     * Usage:
+     * <pre>
+     * CommandString cmd;
+     * if (cmd.split(line) == CommandString::Result::Split) {
+     *     ctx.parseArgs(cmd.argc(), cmd.argv(), schema);
+     * }
+     * </pre>
+     */
+    class CommandString {
+    public:
+        enum class Result {
+            Split = 0,
+            Unterminated, // quote is not closed
+        };
+        CommandString() : badArgumentIndex(0), badArgumentOffset(0), pBase(nullptr), firstWord(0), args() {};
+        CommandString(const CommandString&) = delete; // no copy constructor
+        CommandString& operator=(const CommandString&) = delete; // no assignment operator
+        Result split(char* pCommand, size_t size, const char* pProgram = nullptr);
+        /**
+         * splits the string in place
+         * @param command command line, its content is overwritten
+         * @param pProgram argv[0] when the string holds the arguments only, nullptr when its first word is the program
+         * @return split result
+         */
+        Result split(std::string& command, const char* pProgram = nullptr) {
+            return split(command.data(), command.size(), pProgram);
+        }
+        [[nodiscard]] int argc() const noexcept { return args.empty() ? 0 : static_cast<int>(args.size() - 1); }
+        [[nodiscard]] char** argv() noexcept { return args.data(); }
+        size_t offsetOf(size_t index) const noexcept;
+        size_t badArgumentIndex; // the argument which is not terminated
+        size_t badArgumentOffset; // the byte offset of the unclosed quote in the command string
+    private:
+        const char* pBase; // the last split command string
+        size_t firstWord; // argv index of the first word of the string
+        std::vector<char*> args; // split arguments followed by nullptr
+    };
+}
+
+#endif //APP_COMMAND_STRING_H
@@ -4,156 +4,603 @@
 #include <cstdlib>
 #include "appConfig.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cmath>
 #include <cstring>
 #include <filesystem>
 #include <iostream>
-#include <sstream>
+#include "appNumeric.h"
+#include "appStats.h"
+#if defined(_WIN32)
+#include <stdlib.h>
+#else
+extern char** environ;
+#endif
 using namespace app::config;
 std::unique_ptr<Config> Config::instance; // the only instance
 std::once_flag Config::initFlag; // instance protection flag
 /**
- * converts string into an integer value and stores it to the config
+ * maps every option without environment variable to the prefixed upper-cased option name, '-' becomes '_'.
+ * Call it before the schema is built
+ * @param optMap options to parse command line
+ * @param prefix variable names prefix, e.g. "MYAPP_"
+ */
+void app::arguments::mapEnvironment(std::vector<Options>& optMap, std::string_view prefix) {
+    for (auto& opt : optMap) {
+        if (!opt.envName.empty()) {
+            continue;
+        }
+        opt.envName.reserve(prefix.size() + opt.name.size());
+        opt.envName.assign(prefix);
+        for (const char c : opt.name) {
+            opt.envName.push_back(c == '-' ? '_' : static_cast<char>(::toupper(static_cast<unsigned char>(c))));
+        }
+    }
+}
+
+/**
+ * converts string into a numeric value
  * @param str1 command argument string
- * @param base 10 for human-readable integers or 16 for less readable integers
+ * @param valueType one of the numeric value types
  * @param defVal default value
- * @throws std::invalid_argument when conversion impossible
+ * @param ret receives extracted value, default value for an empty string
+ * @return conversion outcome
  */
-template <typename T>
-app::arguments::Value setIntTempl(const char* optArg, const int base, const app::arguments::DefaultValue& defVal) {
+static app::arguments::ConvResult setNumber(const char* str1, const app::arguments::ValueType valueType, const app::arguments::DefaultValue& defVal,
+    app::arguments::Value& ret) {
+    const auto res = app::arguments::toValue(str1, valueType, ret);
+    if (res == app::arguments::ConvResult::Ok) {
+        return res;
+    }
+    if (res == app::arguments::ConvResult::Empty && defVal.has_value()) {
+        ret = defVal.value();
+        return app::arguments::ConvResult::Ok;
+    }
+    APP_STATS_COUNT(conversionFailures);
+    return res;
+}
 
-    if (optArg !=nullptr && strlen(optArg)>0) {
-        if (base==16) {
-            if (optArg[0] == '0' && (optArg[1] == 'x' || optArg[1] == 'X')) {
-                optArg += 2;
+/**
+ * compares a number with a bound of any numeric type, integers are compared exactly
+ * @param val number
+ * @param bound int32_t, int64_t or double bound
+ * @return negative, zero or positive as the number is less than, equal to or greater than the bound
+ */
+template <typename T>
+static int compareBound(const T val, const app::arguments::Value& bound) noexcept {
+    return std::visit([val](const auto& b) -> int {
+        typedef std::decay_t<decltype(b)> B;
+        if constexpr (std::is_same_v<B, int32_t> || std::is_same_v<B, int64_t> || std::is_same_v<B, double>) {
+            if constexpr (std::is_floating_point_v<T> || std::is_floating_point_v<B>) {
+                const double l = static_cast<double>(val);
+                const double r = static_cast<double>(b);
+                return l < r ? -1 : (l > r ? 1 : 0);
+            }
+            else {
+                const int64_t l = val;
+                const int64_t r = b;
+                return l < r ? -1 : (l > r ? 1 : 0);
             }
         }
-        std::istringstream iss(optArg);
-        iss.exceptions(std::istream::failbit | std::istream::badbit);
-        if (base == 16) {
-            iss >> std::hex;
-        }
-        try
-        {
-            T ret;
-            iss >> ret;
-            return app::arguments::Value(ret);
+        else {
+            return 0;
         }
-        catch (const std::exception&)
-        {
-            throw std::invalid_argument("setIntTempl: invalid value");
+    }, bound);
+}
+
+/**
+ * tests a number against the option range, NaN is never in a range
+ * @param val number
+ * @param opt options providing the range
+ * @return true when the number is within the range
+ */
+template <typename T>
+static bool inRange(const T val, const app::arguments::Options& opt) noexcept {
+    if constexpr (std::is_floating_point_v<T>) {
+        if (std::isnan(val)) {
+            return false;
         }
     }
-    else {
-        if (defVal.has_value()) {
-            return defVal.value();
+    return (!opt.minValue.has_value() || compareBound(val, *opt.minValue) >= 0) &&
+        (!opt.maxValue.has_value() || compareBound(val, *opt.maxValue) <= 0);
+}
+
+/**
+ * checks the converted number or the list elements against the option range
+ * @param val converted value
+ * @param opt options providing the range
+ * @param from the first list element to check
+ * @return ConvResult::OutOfRange when a number is out of range, ConvResult::Ok otherwise
+ */
+static app::arguments::ConvResult checkRange(const app::arguments::Value& val, const app::arguments::Options& opt, const size_t from) noexcept {
+    if (!opt.minValue.has_value() && !opt.maxValue.has_value()) {
+        return app::arguments::ConvResult::Ok;
+    }
+    const bool bInRange = std::visit([&opt, from](const auto& v) {
+        typedef std::decay_t<decltype(v)> T;
+        if constexpr (std::is_same_v<T, int32_t> || std::is_same_v<T, int64_t> || std::is_same_v<T, double>) {
+            return inRange(v, opt);
+        }
+        else if constexpr (std::is_same_v<T, std::vector<int32_t>> || std::is_same_v<T, std::vector<int64_t>> ||
+            std::is_same_v<T, std::vector<double>>) {
+            return std::all_of(v.begin() + std::min(from, v.size()), v.end(), [&opt](const auto item) {
+                return inRange(item, opt);
+            });
+        }
+        else {
+            return true;
         }
+    }, val);
+    if (!bInRange) {
+        APP_STATS_COUNT(conversionFailures);
+        return app::arguments::ConvResult::OutOfRange;
     }
-    throw std::invalid_argument("setIntTempl: invalid value");
+    return app::arguments::ConvResult::Ok;
 }
 
 /**
- * extracts double value from string
- * @param str1 string containing double value
- * @param defVal default value
- * @return extracted value, default value
- * @throws std::invalid_argument when conversion impossible
+ * resolves enumeration name into its index
+ * @param str1 command argument string
+ * @param opt enumeration options
+ * @param ret receives the name index, default value for an empty string
+ * @return conversion outcome
  */
-static app::arguments::Value setDouble(const char* str1, const app::arguments::DefaultValue& defVal) {
-    if (str1!=nullptr) {
-        char* pEnd = nullptr;
-        const double ret = strtod(str1, &pEnd);
-        if (pEnd - str1>0) {
-            return ret;
-        }
+static app::arguments::ConvResult setEnum(const char* str1, const app::arguments::Options& opt, app::arguments::Value& ret) {
+    const int32_t idx = opt.findEnum(str1);
+    if (idx >= 0) {
+        ret = idx;
+        return app::arguments::ConvResult::Ok;
     }
-    else {
-        if (defVal.has_value()) {
-            return defVal.value();
-        }
+    if (*str1 == '\0' && opt.defaultValue.has_value()) {
+        ret = opt.defaultValue.value();
+        return app::arguments::ConvResult::Ok;
+    }
+    APP_STATS_COUNT(conversionFailures);
+    return app::arguments::ConvResult::NotName;
+}
+
+/**
+ * splits comma separated values and appends them to the list
+ * @param str1 command argument string
+ * @param valueType one of the list value types
+ * @param list receives the elements, it is replaced when it holds another type
+ * @return conversion outcome of the first bad element or ConvResult::Ok
+ */
+static app::arguments::ConvResult setList(const char* str1, const app::arguments::ValueType valueType, app::arguments::Value& list) {
+    const auto res = app::arguments::appendList(str1, valueType, list);
+    if (res != app::arguments::ConvResult::Ok) {
+        APP_STATS_COUNT(conversionFailures);
     }
-    throw std::invalid_argument("setDouble: invalid value");
+    return res;
 }
 
 /**
  * extracts string value
  * @param str1 passed value
- * @param defVal default value
- * @return extracted string
- * @throws std::invalid_argument when extraction failed
+ * @param opt options providing default value
+ * @param mode string storage mode
+ * @param ret receives extracted string
+ * @return conversion outcome
  */
-static app::arguments::Value setString(const char* str1, const app::arguments::DefaultValue& defVal) {
+static app::arguments::ConvResult setString(const char* str1, const app::arguments::Options& opt, const app::arguments::StringMode mode,
+    app::arguments::Value& ret) {
     if (str1!=nullptr) {
-        return str1;
+        if (mode != app::arguments::StringMode::Copy) {
+            ret = app::arguments::BorrowedString(str1);
+        }
+        else {
+            ret = str1;
+        }
+        return app::arguments::ConvResult::Ok;
     }
     else {
-        if (defVal.has_value()) {
-            return defVal.value();
+        if (opt.defaultValue.has_value()) {
+            ret = opt.acquireDefault(mode);
+            return app::arguments::ConvResult::Ok;
+        }
+    }
+    return app::arguments::ConvResult::Missing;
+}
+
+/**
+ * enumeration option, its value is the int32_t index of the name passed
+ * @param sc short option character
+ * @param name long option name
+ * @param descr description
+ * @param mandatory option type
+ * @param names enumeration names
+ * @param dv default value, a name or its int32_t index
+ * @throws std::invalid_argument when the default value is not one of the names
+ */
+app::arguments::Options::Options(const char sc, std::string name, std::string descr, const Type mandatory,
+    std::vector<std::string> names, DefaultValue dv) :
+    name(std::move(name)), type(mandatory), desc(std::move(descr)), shortCut(sc), valueType(ValueType::Enum), defaultValue(),
+    envName(), shortUtf8(), minValue(), maxValue(), enumNames(std::move(names)), enumIndex() {
+    if (!dv.has_value()) {
+        return;
+    }
+    int32_t idx = -1;
+    if (const auto* pName = std::get_if<std::string>(&dv.value())) {
+        idx = findEnum(*pName);
+    }
+    else if (const auto* pIdx = std::get_if<int32_t>(&dv.value())) {
+        idx = *pIdx < static_cast<int64_t>(enumNames.size()) ? *pIdx : -1;
+    }
+    if (idx < 0) {
+        APP_THROW(std::invalid_argument("Options: default value is not an enumeration name"));
+    }
+    defaultValue = idx;
+}
+
+/**
+ * resolves enumeration name with the perfect hash built by the schema, or by comparing the names when the options
+ * are not a part of a schema
+ * @param str the name
+ * @return the name index or -1 when it is not an enumeration name
+ */
+int32_t app::arguments::Options::findEnum(std::string_view str) const noexcept {
+    if (!enumIndex.empty()) {
+        return enumIndex.find(str, enumNames);
+    }
+    for (size_t i = 0; i < enumNames.size(); i++) {
+        if (enumNames[i] == str) {
+            return static_cast<int32_t>(i);
+        }
+    }
+    return -1;
+}
+
+/**
+ * returns default value. In borrow and arena modes string default is returned as a view into the options
+ * @param mode string storage mode
+ * @return default value
+ * @throws std::bad_optional_access when there is no default value
+ */
+app::arguments::Value app::arguments::Options::acquireDefault(const StringMode mode) const {
+    const auto& val = defaultValue.value();
+    if (mode != StringMode::Copy) {
+        if (const auto* pStr = std::get_if<std::string>(&val)) {
+            return BorrowedString(*pStr);
         }
     }
-    throw std::invalid_argument("setString: invalid value");
+    return val;
 }
 
 /**
  * acquires value from C-string, according to the configured options
  * @param optArg input parameter
+ * @param mode string storage mode
  * @return extracted value
- * @throws std::invalid_argument when required parameter is missing
+ * @throws std::invalid_argument when required parameter is missing or conversion impossible
+ * @throws app::arguments::RangeError when a number is out of range
+ */
+app::arguments::Value app::arguments::Options::acquireValue(const char* optArg, const StringMode mode) const {
+    Value ret;
+    const auto res = tryAcquireValue(optArg, mode, ret);
+    if (res != ConvResult::Ok) {
+        APP_STATS_COUNT(exceptionsThrown);
+        if (res == ConvResult::OutOfRange) {
+            APP_THROW(RangeError("acquireValue: value out of range"));
+        }
+        APP_THROW(std::invalid_argument(std::string("acquireValue: ") + toString(res)));
+    }
+    return ret;
+}
+
+/**
+ * acquires value from C-string without throwing on bad input, the parse path uses it
+ * @param optArg input parameter
+ * @param mode string storage mode
+ * @param val receives extracted value, it may be modified on failure
+ * @return conversion outcome, ConvResult::Missing when required parameter is missing
  */
-app::arguments::Value app::arguments::Options::acquireValue(const char* optArg) const {
+app::arguments::ConvResult app::arguments::Options::tryAcquireValue(const char* optArg, const StringMode mode, Value& val) const {
+    APP_STATS_PHASE(Conversion);
     if (optArg == nullptr) {
         if (type==Type::Mandatory) {
-            throw std::invalid_argument("Required option not provided");
+            return ConvResult::Missing;
         }
         if (defaultValue.has_value()) {
-            return defaultValue.value();
+            val = acquireDefault(mode);
         }
         else {
-            return true;
+            val = true;
+        }
+        return ConvResult::Ok;
+    }
+    APP_STATS_COUNT(conversions[static_cast<size_t>(valueType)]);
+    switch (valueType) {
+        case app::arguments::ValueType::Int32:
+        case app::arguments::ValueType::Int32h:
+        case app::arguments::ValueType::Int64:
+        case app::arguments::ValueType::Int64h:
+        case app::arguments::ValueType::Float: {
+            const auto res = setNumber(optArg, valueType, defaultValue, val);
+            return res == ConvResult::Ok ? checkRange(val, *this, 0) : res;
+        }
+        case app::arguments::ValueType::Enum:
+            return setEnum(optArg, *this, val);
+        case app::arguments::ValueType::StringList:
+        case app::arguments::ValueType::Int32List:
+        case app::arguments::ValueType::Int32hList:
+        case app::arguments::ValueType::Int64List:
+        case app::arguments::ValueType::Int64hList:
+        case app::arguments::ValueType::FloatList: {
+            val = Value();
+            const auto res = setList(optArg, valueType, val);
+            return res == ConvResult::Ok ? checkRange(val, *this, 0) : res;
+        }
+        default:
+        case app::arguments::ValueType::String:
+            return setString(optArg, *this, mode, val);
+    }
+}
+
+/**
+ * appends the elements of repeated list option
+ * @param optArg input parameter, comma separated values
+ * @param list the option value collected so far
+ * @throws std::invalid_argument when the option is not a list or an element conversion impossible
+ * @throws app::arguments::RangeError when an element is out of range
+ */
+void app::arguments::Options::appendValue(const char* optArg, Value& list) const {
+    const auto res = tryAppendValue(optArg, list);
+    if (res != ConvResult::Ok) {
+        APP_STATS_COUNT(exceptionsThrown);
+        if (res == ConvResult::OutOfRange) {
+            APP_THROW(RangeError("appendValue: value out of range"));
+        }
+        APP_THROW(std::invalid_argument(std::string("appendValue: ") + toString(res)));
+    }
+}
+
+/**
+ * appends the elements of repeated list option without throwing on bad input
+ * @param optArg input parameter, comma separated values
+ * @param list the option value collected so far, the elements before a bad one are appended
+ * @return conversion outcome, ConvResult::NotList when the option is not a list
+ */
+app::arguments::ConvResult app::arguments::Options::tryAppendValue(const char* optArg, Value& list) const {
+    APP_STATS_PHASE(Conversion);
+    if (optArg == nullptr || !isList(valueType)) {
+        return ConvResult::NotList;
+    }
+    APP_STATS_COUNT(conversions[static_cast<size_t>(valueType)]);
+    const size_t from = std::visit([](const auto& v) -> size_t {
+        typedef std::decay_t<decltype(v)> T;
+        if constexpr (std::is_same_v<T, std::vector<int32_t>> || std::is_same_v<T, std::vector<int64_t>> ||
+            std::is_same_v<T, std::vector<double>>) {
+            return v.size();
+        }
+        else {
+            return 0;
+        }
+    }, list);
+    const auto res = setList(optArg, valueType, list);
+    return res == ConvResult::Ok ? checkRange(list, *this, from) : res;
+}
+
+/**
+ * copies string into the memory resource, the copy is '\0' terminated
+ * @param str string to copy
+ * @return the copy
+ */
+app::arguments::BorrowedString ParseContext::arenaString(std::string_view str) const {
+    char* pCopy = static_cast<char*>(pResource->allocate(str.size() + 1, 1));
+    std::memcpy(pCopy, str.data(), str.size());
+    pCopy[str.size()] = '\0';
+    return app::arguments::BorrowedString(std::string_view(pCopy, str.size()));
+}
+
+/**
+ * stores parameter value into configuration. In StringMode::Arena string values are copied into the memory resource
+ * @param idx options index
+ * @param val value to store
+ */
+void ParseContext::setValue(size_t idx, app::arguments::Value val) {
+    const app::arguments::MaskWord bit = app::arguments::MaskWord(1) << (idx % app::arguments::MASK_WORD_BITS);
+    if (stringMode == app::arguments::StringMode::Arena) {
+        if (const auto* pStr = std::get_if<app::arguments::BorrowedString>(&val)) {
+            val = arenaString(*pStr);
+        }
+    }
+    values[idx] = std::move(val);
+    present[idx / app::arguments::MASK_WORD_BITS] |= bit;
+    assigned[idx / app::arguments::MASK_WORD_BITS] |= bit;
+    if (pending) {
+        pending[idx / app::arguments::MASK_WORD_BITS].fetch_and(~bit, std::memory_order_relaxed); // overrides lazy value
+    }
+}
+
+/**
+ * converts the lazy value, the first caller converts and the others wait for it
+ * @param idx options index
+ * @return false when the value cannot be converted
+ */
+bool ParseContext::convert(size_t idx) const {
+    std::lock_guard<std::mutex> lock(*pConvertLock);
+    auto& word = pending[idx / app::arguments::MASK_WORD_BITS];
+    const app::arguments::MaskWord bit = app::arguments::MaskWord(1) << (idx % app::arguments::MASK_WORD_BITS);
+    if ((word.load(std::memory_order_relaxed) & bit) == 0) {
+        return true; // converted by another thread
+    }
+    const auto& opt = (*pSchema)[idx];
+    app::arguments::Value val;
+    const auto res = opt.tryAcquireValue(raw[idx], stringMode, val);
+    if (res != app::arguments::ConvResult::Ok) {
+        if (opt.type != app::arguments::Type::Optional || res == app::arguments::ConvResult::OutOfRange) {
+            return false;
+        }
+        val = true;
+    }
+    if (stringMode == app::arguments::StringMode::Arena) {
+        if (const auto* pStr = std::get_if<app::arguments::BorrowedString>(&val)) {
+            val = arenaString(*pStr);
+        }
+    }
+    values[idx] = std::move(val);
+    word.fetch_and(~bit, std::memory_order_release);
+    return true;
+}
+
+/**
+ * converts all lazy values and validates the configuration
+ * @return the first option which value cannot be converted, otherwise valid() result
+ */
+size_t ParseContext::validateAll() {
+    for (size_t w = 0; w < pendingWords && pending; w++) {
+        for (app::arguments::MaskWord bits = pending[w].load(std::memory_order_acquire); bits != 0; bits &= bits - 1) {
+            const size_t idx = w * app::arguments::MASK_WORD_BITS + app::arguments::lowestBit(bits);
+            if (!resolve(idx)) {
+                return idx;
+            }
+        }
+    }
+    return valid();
+}
+
+/**
+ * clears configuration and populates it with mandatory parameters default values, the next merge() or mergeArgs()
+ * calls use the schema. Values storage is reused when the same schema is parsed again
+ * @param schema compiled options to parse command line
+ */
+void ParseContext::reset(const app::arguments::ParserSchema& schema) {
+    const size_t count = schema.size();
+    if (&schema != ownedSchema.get()) {
+        ownedSchema.reset();
+    }
+    pSchema = &schema;
+    if (values.size() != count) {
+        values.resize(count);
+    }
+    present.assign(app::arguments::maskWords(count), 0);
+    assigned.assign(app::arguments::maskWords(count), 0);
+    if (lazy) {
+        const size_t words = app::arguments::maskWords(count);
+        if (!pending || pendingWords != words) {
+            pending.reset(new std::atomic<app::arguments::MaskWord>[words]);
+            pendingWords = words;
+        }
+        for (size_t w = 0; w < words; w++) {
+            pending[w].store(0, std::memory_order_relaxed);
+        }
+        raw.resize(count);
+        if (!pConvertLock) {
+            pConvertLock = std::make_unique<std::mutex>();
         }
     }
     else {
-        switch (valueType) {
-            case app::arguments::ValueType::Int32:
-                return  setIntTempl<int32_t>(optArg, 10, defaultValue);
-            case app::arguments::ValueType::Int32h:
-                return setIntTempl<int32_t>(optArg, 16, defaultValue);
-            case app::arguments::ValueType::Int64:
-                return setIntTempl<int64_t>(optArg, 10, defaultValue);
-            case app::arguments::ValueType::Int64h:
-                return setIntTempl<int64_t>(optArg, 16, defaultValue);
-            case app::arguments::ValueType::Float:
-                return setDouble(optArg,defaultValue);
-            default:
-            case app::arguments::ValueType::String:
-                return setString(optArg, defaultValue);
+        pending.reset();
+        pendingWords = 0;
+    }
+    lastParsed = badArgumentIndex = badArgumentOffset = 0;
+    errorKind = ErrorKind::None;
+    for (size_t i=0; i<count; i++) {
+        // populates configuration with mandatory parameters defaut values
+        if (schema[i].type == app::arguments::Type::Mandatory && schema[i].defaultValue.has_value()) {
+            values[i] = schema[i].acquireDefault(stringMode);
+            present[i / app::arguments::MASK_WORD_BITS] |= app::arguments::MaskWord(1) << (i % app::arguments::MASK_WORD_BITS);
         }
     }
-    //throw std::invalid_argument("acquireValue: invalid value");
 }
 
 /**
- * fills configuration with parameter value from input C-String
+ * fills configuration with parameter value from input C-String, in lazy mode only the input is recorded.
+ * List values are converted at once, repeated list option appends to the value of the same merge() or mergeArgs()
+ * call and replaces the value of the previous calls
  * @param idx options index
+ * @param opt options
  * @param optArg input C-String
- * @param optMap options vector
- * @throws std::invalid_argument when options does not meet input
+ * @return conversion outcome, an optional option which value cannot be converted is set to true
+ * unless the value is out of range
  */
-void Config::fillIn(const app::arguments::Options& opt, const char* optArg) {
-    switch (opt.type) {
-        case app::arguments::Type::None:
-            config[opt.name] = true;
-            break;
-        case app::arguments::Type::Optional:
-            try {
-                config[opt.name] = opt.acquireValue(optArg);
-            } catch (const std::invalid_argument&) {
-                config[opt.name] = true;
+app::arguments::ConvResult ParseContext::fillIn(size_t idx, const app::arguments::Options& opt, const char* optArg) {
+    if (optArg != nullptr && app::arguments::isList(opt.valueType) && opt.type != app::arguments::Type::None) {
+        const size_t word = idx / app::arguments::MASK_WORD_BITS;
+        const app::arguments::MaskWord bit = app::arguments::MaskWord(1) << (idx % app::arguments::MASK_WORD_BITS);
+        if ((appended[word] & bit) != 0) {
+            return opt.tryAppendValue(optArg, values[idx]);
+        }
+        app::arguments::Value val;
+        const auto res = opt.tryAcquireValue(optArg, stringMode, val);
+        if (res == app::arguments::ConvResult::Ok) {
+            setValue(idx, std::move(val));
+            appended[word] |= bit;
+        }
+        return res;
+    }
+    if (pending && optArg != nullptr && opt.type != app::arguments::Type::None) {
+        const size_t word = idx / app::arguments::MASK_WORD_BITS;
+        const app::arguments::MaskWord bit = app::arguments::MaskWord(1) << (idx % app::arguments::MASK_WORD_BITS);
+        raw[idx] = optArg;
+        present[word] |= bit;
+        assigned[word] |= bit;
+        pending[word].fetch_or(bit, std::memory_order_relaxed);
+        return app::arguments::ConvResult::Ok;
+    }
+    if (opt.type == app::arguments::Type::None) {
+        setValue(idx, true);
+        return app::arguments::ConvResult::Ok;
+    }
+    app::arguments::Value val;
+    const auto res = opt.tryAcquireValue(optArg, stringMode, val);
+    if (res == app::arguments::ConvResult::Ok) {
+        setValue(idx, std::move(val));
+    }
+    else if (opt.type == app::arguments::Type::Optional && res != app::arguments::ConvResult::OutOfRange) {
+        setValue(idx, true); // a number out of range is not a missing value
+        return app::arguments::ConvResult::Ok;
+    }
+    return res;
+}
+
+/**
+ * maps conversion failure into the parse failure reason
+ * @param res conversion outcome
+ * @return failure reason
+ */
+static ErrorKind toErrorKind(const app::arguments::ConvResult res) noexcept {
+    switch (res) {
+        case app::arguments::ConvResult::Ok:
+            return ErrorKind::None;
+        case app::arguments::ConvResult::Missing:
+            return ErrorKind::MissingValue;
+        case app::arguments::ConvResult::OutOfRange:
+            return ErrorKind::OutOfRange;
+        default:
+            return ErrorKind::BadValue;
+    }
+}
+
+/**
+ * converts an environment variable value of a flag option
+ * @param str variable value, 1/true/yes/on set the flag, 0/false/no/off and an empty value leave it unset,
+ * case-insensitive
+ * @param ret receives the flag state
+ * @return ConvResult::Ok or ConvResult::Invalid for another value
+ */
+static app::arguments::ConvResult toFlag(const std::string_view str, bool& ret) noexcept {
+    const auto equals = [str](const std::string_view name) noexcept {
+        if (str.size() != name.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < str.size(); i++) {
+            if (std::tolower(static_cast<unsigned char>(str[i])) != name[i]) {
+                return false;
             }
-            break;
-        case app::arguments::Type::Mandatory:
-            config[opt.name] = opt.acquireValue(optArg);
-            break;
+        }
+        return true;
+    };
+    if (equals("1") || equals("true") || equals("yes") || equals("on")) {
+        ret = true;
+        return app::arguments::ConvResult::Ok;
+    }
+    if (str.empty() || equals("0") || equals("false") || equals("no") || equals("off")) {
+        ret = false;
+        return app::arguments::ConvResult::Ok;
     }
+    return app::arguments::ConvResult::Invalid;
 }
 
 /**
@@ -163,117 +610,475 @@ void Config::fillIn(const app::arguments::Options& opt, const char* optArg) {
  * @param optMap options to parse command line
  * @return parse result
  */
-ParseResult Config::parseArgs(int argc, char** argv, const std::vector<app::arguments::Options>& optMap) {
-    config.clear();
-    size_t i;
-    size_t argCount = argc;
-    size_t count = optMap.size();
-    std::shared_ptr<char> pBuf(new char[count]);
-    std::map<std::string, size_t> longMap;
-    lastParsed = badArgumentIndex = badArgumentOffset = 0;
+ParseResult ParseContext::parseArgs(int argc, char** argv, const std::vector<app::arguments::Options>& optMap) {
+    ownedSchema = std::make_unique<app::arguments::ParserSchema>(optMap);
+    return parseArgs(argc, argv, *ownedSchema);
+}
 
-    for (i=0; i<count; i++) {
-        pBuf.get()[i] = optMap[i].shortCut;
-        longMap[optMap[i].name] = i;
-        // populates configuration with mandatory parameters defaut values
-        if (optMap[i].type == app::arguments::Type::Mandatory && optMap[i].defaultValue.has_value()) {
-            config[optMap[i].name] = optMap[i].defaultValue.value();
-        }
+/**
+ * parses classic command line arguments from main() function using prebuilt lookup tables
+ * @param argc argument count
+ * @param argv argument values
+ * @param schema compiled options to parse command line
+ * @return parse result
+ */
+ParseResult ParseContext::parseArgs(int argc, char** argv, const app::arguments::ParserSchema& schema) {
+    reset(schema);
+    return mergeArgs(argc, argv);
+}
+
+/**
+ * parses classic command line arguments without exceptions: bad input is never thrown internally and the failure
+ * is returned with its reason, so hostile input costs no stack unwinding. The library builds with -fno-exceptions,
+ * an allocation failure terminates the process then. Usage:
+ * <pre>
+ * if (auto res = ctx.tryParseArgs(argc, argv, schema); !res) {
+ *     report(res.error().kind, res.error().index, res.error().offset);
+ * }
+ * </pre>
+ * @param argc argument count
+ * @param argv argument values
+ * @param schema compiled options to parse command line
+ * @return success or the failure with the argument index and the byte offset in it
+ */
+ParseOutcome ParseContext::tryParseArgs(int argc, char** argv, const app::arguments::ParserSchema& schema) noexcept {
+    const ParseResult res = parseArgs(argc, argv, schema);
+    if (res == ParseResult::Parsed) {
+        return ParseOutcome();
+    }
+    return ParseOutcome(ParseError{ res, errorKind, badArgumentIndex, badArgumentOffset });
+}
+
+/**
+ * parses wide character command line arguments of wmain(), they are converted into UTF-8 kept by the context
+ * until the next wide character parse
+ * @param argc argument count
+ * @param argv wide character argument values
+ * @param schema compiled options to parse command line
+ * @return parse result, ParseResult::BadEncoding with the wchar_t offset of a character not convertible to UTF-8,
+ * ParseResult::Error with ErrorKind::NullArgument for a nullptr argument as the narrow parse
+ */
+ParseResult ParseContext::parseArgs(int argc, wchar_t** argv, const app::arguments::ParserSchema& schema) {
+    reset(schema);
+    if (!wideArgs) {
+        wideArgs = std::make_unique<WideArguments>();
+    }
+    const WideArguments::Result converted = wideArgs->convert(argc, argv);
+    if (converted == WideArguments::Result::NullArgument) {
+        return reject(ParseResult::Error, ErrorKind::NullArgument, wideArgs->badArgumentIndex);
+    }
+    if (converted != WideArguments::Result::Converted) {
+        badArgumentOffset = wideArgs->badArgumentOffset;
+        return reject(ParseResult::BadEncoding, ErrorKind::BadEncoding, wideArgs->badArgumentIndex);
     }
-    for (i=1; i<argCount; i++) {
-        if (!argv[i]) {
-            badArgumentIndex = i;
-            return ParseResult::Error;
+    const bool bValidate = utf8Validation;
+    utf8Validation = false; // converted arguments are valid
+    const ParseResult res = mergeArgs(wideArgs->argc(), wideArgs->argv());
+    utf8Validation = bValidate;
+    return res;
+}
+
+/**
+ * splits a command line given as one string with POSIX shell quoting and parses it, the first word is the program
+ * name. The string is split in place into the argv storage kept by the context, which is reused by the next command
+ * string parse, see CommandString. The string must outlive the values in StringMode::Borrow
+ * @param pCommand command line, its content and pCommand[size] are overwritten
+ * @param size command line length
+ * @param schema compiled options to parse command line
+ * @return parse result, ParseResult::Error for a quote which is not closed: badArgumentIndex is the index the argument
+ * would have and badArgumentOffset is the quote offset in the string
+ */
+ParseResult ParseContext::parseCommand(char* pCommand, size_t size, const app::arguments::ParserSchema& schema) {
+    reset(schema);
+    if (!commandArgs) {
+        commandArgs = std::make_unique<CommandString>();
+    }
+    if (commandArgs->split(pCommand, size) != CommandString::Result::Split) {
+        badArgumentOffset = commandArgs->badArgumentOffset;
+        return reject(ParseResult::Error, ErrorKind::Unterminated, commandArgs->badArgumentIndex);
+    }
+    return mergeArgs(commandArgs->argc(), commandArgs->argv());
+}
+
+/**
+ * parses configuration file and then command line arguments, command line values override file values
+ * @param argc argument count
+ * @param argv argument values
+ * @param schema compiled options to parse command line
+ * @param file loaded configuration file, it must outlive the values in StringMode::Borrow
+ * @return parse result
+ */
+ParseResult ParseContext::parseArgs(int argc, char** argv, const app::arguments::ParserSchema& schema, const ConfigFile& file) {
+    reset(schema);
+    const ParseResult res = merge(file);
+    if (res != ParseResult::Parsed) {
+        return res;
+    }
+    return mergeArgs(argc, argv);
+}
+
+/**
+ * parses environment variables and then command line arguments, command line values override environment values
+ * and environment values override default values
+ * @param argc argument count
+ * @param argv argument values
+ * @param schema compiled options to parse command line
+ * @param envp environment block as main() third argument, nullptr for the process environment
+ * @return parse result
+ */
+ParseResult ParseContext::parseArgs(int argc, char** argv, const app::arguments::ParserSchema& schema, char** envp) {
+    reset(schema);
+    const ParseResult res = mergeEnvironment(envp);
+    if (res != ParseResult::Parsed) {
+        return res;
+    }
+    return mergeArgs(argc, argv);
+}
+
+/**
+ * parses the environment variables of the options over the current values using the schema passed to reset().
+ * The environment is read in a single pass: entries without the common variable prefix are skipped at once and
+ * the others are looked up in the sorted variable names. A flag option is set by 1/true/yes/on and left unset by
+ * 0/false/no/off or an empty value, another value fails. On failure badArgumentIndex is the environment entry index
+ * @param envp environment block as main() third argument, nullptr for the process environment.
+ * It must outlive the values in StringMode::Borrow and in lazy mode
+ * @return parse result
+ */
+ParseResult ParseContext::mergeEnvironment(char** envp) {
+    if (pSchema == nullptr) {
+        return ParseResult::None;
+    }
+    APP_STATS_PHASE(Tokenize);
+    const auto& schema = *pSchema;
+    appended.assign(app::arguments::maskWords(schema.size()), 0);
+    if (!schema.hasEnvironment()) {
+        return ParseResult::Parsed;
+    }
+    if (envp == nullptr) {
+#if defined(_WIN32)
+        envp = _environ;
+#else
+        envp = environ;
+#endif
+    }
+    const std::string_view prefix = schema.envPrefix();
+    for (size_t i = 0; envp != nullptr && envp[i] != nullptr; i++) {
+        const char* pEntry = envp[i];
+        if (std::strncmp(pEntry, prefix.data(), prefix.size()) != 0) {
+            continue;
         }
-        if (argv[i][0]=='-') {
-            if (argv[i][1]=='-') {
-                if (argv[i][2] == '\0') {
-                    // have just received '--' argument, next arguments won't be parsed
-                    lastParsed = i;
-                    break;
-                }
-                // long option
-                try {
-                    size_t idx = longMap.at(argv[i]+2);
-                    const auto& rOpt = optMap[idx];
-                    if (rOpt.type!=app::arguments::Type::None) {
-                        if (i+1<argc && argv[i+1][0]!='-') {
-                            i ++;
-                            fillIn(rOpt, argv[i]);
-                        }
-                        else {
-                            if (rOpt.type == app::arguments::Type::Mandatory) {
-                                return ParseResult::Error;
-                            }
-                            else {
-                                config[rOpt.name] = true;
-                            }
-                        }
-                    }
-                    else {
-                        fillIn(rOpt, nullptr);
-                    }
-                } catch (const std::out_of_range&) {
-                    badArgumentIndex = i;
-                    return ParseResult::BadOptionIndex;
-
-                } catch (const std::invalid_argument&) {
-                    badArgumentIndex = i;
-                    return ParseResult::Error;
-                }
+        const char* pValue = std::strchr(pEntry + prefix.size(), '=');
+        if (pValue == nullptr) {
+            continue;
+        }
+        const size_t idx = schema.findEnv(std::string_view(pEntry, pValue - pEntry));
+        if (idx == app::arguments::ParserSchema::npos) {
+            continue;
+        }
+        auto res = app::arguments::ConvResult::Ok;
+        if (schema[idx].type == app::arguments::Type::None) {
+            bool bFlag = false;
+            res = toFlag(pValue + 1, bFlag);
+            if (res == app::arguments::ConvResult::Ok && bFlag) {
+                res = fillIn(idx, schema[idx], pValue + 1);
             }
-            else {
-                // short option(s)
-                const char* ptr = argv[i] + 1;
-                while (*ptr!='\0') {
-                    const char* p = static_cast<const char*>(::memchr(pBuf.get(), *ptr, count));
-                    if (p==nullptr) {
-                        badArgumentIndex = i;
-                        badArgumentOffset = ptr - argv[i];
-                        return ParseResult::Unknown;
-                    }
-                    size_t idx = p - pBuf.get();
-                    try {
-                        const auto& rOpt = optMap[idx];
-                        if (*(ptr+1)=='\0') {
-                            if (i+1<argc && argv[i + 1][0] != '-') {
-                                i ++;
-                                fillIn(rOpt, argv[i]);
-                            }
-                            else {
-                                if (rOpt.type == app::arguments::Type::Mandatory) {
-                                    return ParseResult::Error;
-                                }
-                                else {
-                                    config[rOpt.name] = true;
-                                }
-                            }
-                        }
-                        else {
-                            fillIn(rOpt, nullptr);
-                        }
-                    } catch (const std::out_of_range&) {
-                        badArgumentIndex = i;
-                        return ParseResult::BadOptionIndex;
-                    } catch (const std::invalid_argument&) {
-                        badArgumentIndex = i;
-                        return ParseResult::Error;
-                    }
-                    ptr ++;
-                }
+        }
+        else {
+            res = fillIn(idx, schema[idx], pValue + 1);
+        }
+        if (res != app::arguments::ConvResult::Ok) {
+            return reject(ParseResult::Error, toErrorKind(res), i);
+        }
+    }
+    return ParseResult::Parsed;
+}
+
+/**
+ * parses configuration file entries over the current values using the schema passed to reset().
+ * On failure badArgumentIndex is the file line number
+ * @param file loaded configuration file, it must outlive the values in StringMode::Borrow
+ * @return parse result
+ */
+ParseResult ParseContext::merge(const ConfigFile& file) {
+    if (pSchema == nullptr) {
+        return ParseResult::None;
+    }
+    APP_STATS_PHASE(Tokenize);
+    const auto& schema = *pSchema;
+    appended.assign(app::arguments::maskWords(schema.size()), 0);
+    for (const auto& entry : file.getEntries()) {
+        const size_t idx = schema.findLong(entry.name);
+        if (idx == app::arguments::ParserSchema::npos) {
+            return reject(ParseResult::BadOptionIndex, ErrorKind::UnknownOption, entry.line);
+        }
+        const auto res = fillIn(idx, schema[idx], entry.value);
+        if (res != app::arguments::ConvResult::Ok) {
+            return reject(ParseResult::Error, toErrorKind(res), entry.line);
+        }
+    }
+    return ParseResult::Parsed;
+}
+
+/**
+ * parses command line arguments over the current values using the schema passed to reset()
+ * @param argc argument count
+ * @param argv argument values
+ * @return parse result
+ */
+ParseResult ParseContext::mergeArgs(int argc, char** argv) {
+    if (beginArgs() != ParseResult::Parsed) {
+        return ParseResult::None;
+    }
+    APP_STATS_PHASE(Tokenize);
+    for (int i = 1; i < argc && (streamState == StreamState::Options || streamState == StreamState::AwaitingValue); i++) {
+        step(argv[i]);
+    }
+    return finish();
+}
+
+/**
+ * starts parsing streamed command line arguments over the current values using the schema passed to reset().
+ * The arguments are passed one at a time with feed() and the stream is completed with finish(), so parsing
+ * overlaps with reading the arguments. Usage:
+ * <pre>
+ * ctx.reset(schema);
+ * ctx.beginArgs();
+ * while (readToken(token)) {
+ *     if (ctx.feed(token) != ParseResult::Parsed) {
+ *         break; // rejected at the first bad argument, finish() returns the same result
+ *     }
+ * }
+ * ParseResult res = ctx.finish();
+ * </pre>
+ * @return ParseResult::None when no schema was set, ParseResult::Parsed otherwise
+ */
+ParseResult ParseContext::beginArgs() {
+    if (pSchema == nullptr) {
+        streamState = StreamState::Idle;
+        return ParseResult::None;
+    }
+    appended.assign(app::arguments::maskWords(pSchema->size()), 0);
+    lastParsed = badArgumentIndex = badArgumentOffset = operandIndex = 0;
+    errorKind = ErrorKind::None;
+    streamIndex = 0;
+    streamResult = ParseResult::Parsed;
+    streamState = StreamState::Options;
+    return ParseResult::Parsed;
+}
+
+/**
+ * parses the next streamed argument. The first argument has index 1 as argv[1] of mergeArgs(), an option
+ * expecting a value waits for the next argument. Arguments after "--" are skipped.
+ * In StringMode::Borrow and in lazy mode the argument must outlive the values as argv does
+ * @param arg argument value
+ * @return ParseResult::Parsed when the argument was accepted, the failed result of the stream otherwise,
+ * ParseResult::None when no stream was started
+ */
+ParseResult ParseContext::feed(const char* arg) {
+    if (streamState == StreamState::Idle || streamState == StreamState::Failed) {
+        return streamResult;
+    }
+    APP_STATS_PHASE(Tokenize);
+    return step(arg);
+}
+
+/**
+ * completes the streamed arguments, an option still waiting for its value is parsed as given without value
+ * @return parse result of the stream, ParseResult::None when no stream was started
+ */
+ParseResult ParseContext::finish() {
+    ParseResult res = streamResult;
+    if (streamState == StreamState::AwaitingValue) {
+        res = completeOption();
+    }
+    streamState = StreamState::Idle;
+    streamResult = ParseResult::None;
+    return res;
+}
+
+/**
+ * runs the streamed parse state machine with one argument
+ * @param arg argument value
+ * @return ParseResult::Parsed or the failed result, which is kept in streamResult
+ */
+ParseResult ParseContext::step(const char* arg) {
+    const size_t i = ++streamIndex;
+    if (streamState == StreamState::Stopped) {
+        return ParseResult::Parsed;
+    }
+    ParseResult res = parseArgument(i, arg);
+    if (res != ParseResult::Parsed) {
+        streamState = StreamState::Failed;
+        streamResult = res;
+    }
+    return res;
+}
+
+/**
+ * parses one argument, the pending option takes it as the value unless it starts with a dash
+ * @param i argument index
+ * @param arg argument value
+ * @return parse result
+ */
+ParseResult ParseContext::parseArgument(size_t i, const char* arg) {
+    if (arg == nullptr) {
+        return reject(ParseResult::Error, ErrorKind::NullArgument, i);
+    }
+    if (utf8Validation) {
+        const size_t offset = app::arguments::validateUtf8(arg);
+        if (offset != app::arguments::UTF8_VALID) {
+            badArgumentOffset = offset;
+            return reject(ParseResult::BadEncoding, ErrorKind::BadEncoding, i);
+        }
+    }
+    if (streamState == StreamState::AwaitingValue) {
+        if (arg[0] != '-') {
+            streamState = StreamState::Options;
+            return fillArgument(awaitingIdx, i, arg);
+        }
+        const ParseResult res = completeOption();
+        if (res != ParseResult::Parsed) {
+            return res;
+        }
+    }
+    if (arg[0] != '-') {
+        if (stopAtOperand) {
+            // the operand and the next arguments are left to the caller
+            operandIndex = i;
+            streamState = StreamState::Stopped;
+        }
+        return ParseResult::Parsed;
+    }
+    const auto& schema = *pSchema;
+    if (arg[1]=='-') {
+        if (arg[2] == '\0') {
+            // have just received '--' argument, next arguments won't be parsed
+            lastParsed = i;
+            streamState = StreamState::Stopped;
+            return ParseResult::Parsed;
+        }
+        // long option, the name is matched up to '=' of --name=value
+        const char* pName = arg + 2;
+        const size_t nameLen = std::strcspn(pName, "=");
+        bool bAmbiguous = false;
+        size_t idx = lookupLong(std::string_view(pName, nameLen), bAmbiguous);
+        if (idx == app::arguments::ParserSchema::npos) {
+            return bAmbiguous ? reject(ParseResult::Ambiguous, ErrorKind::AmbiguousOption, i) :
+                reject(ParseResult::BadOptionIndex, ErrorKind::UnknownOption, i);
+        }
+        return parseLong(idx, i, pName[nameLen] == '=' ? pName + nameLen + 1 : nullptr);
+    }
+    if (longOnly && arg[1] != '\0' &&
+        (arg[2] != '\0' || schema.findShort(arg[1]) == app::arguments::ParserSchema::npos)) {
+        // getopt_long_only: a single dash word is a long option when it matches a long name
+        const char* pName = arg + 1;
+        const size_t nameLen = std::strcspn(pName, "=");
+        bool bAmbiguous = false;
+        size_t idx = lookupLong(std::string_view(pName, nameLen), bAmbiguous);
+        if (bAmbiguous) {
+            return reject(ParseResult::Ambiguous, ErrorKind::AmbiguousOption, i);
+        }
+        if (idx != app::arguments::ParserSchema::npos) {
+            return parseLong(idx, i, pName[nameLen] == '=' ? pName + nameLen + 1 : nullptr);
+        }
+    }
+    // short option(s)
+    const char* ptr = arg + 1;
+    while (*ptr!='\0') {
+        // a multi-byte UTF-8 short option is looked up by its whole sequence
+        const size_t seqLen = static_cast<unsigned char>(*ptr) < 0x80 ? 1 :
+            ::strnlen(ptr, app::arguments::utf8SequenceLength(*ptr));
+        size_t idx = seqLen == 1 ? schema.findShort(*ptr) : schema.findShort(std::string_view(ptr, seqLen));
+        if (idx == app::arguments::ParserSchema::npos) {
+            badArgumentOffset = ptr - arg;
+            return reject(ParseResult::Unknown, ErrorKind::UnknownOption, i);
+        }
+        const auto& rOpt = schema[idx];
+        if (rOpt.type != app::arguments::Type::None) {
+            if (ptr[seqLen] != '\0') {
+                // -Ovalue: the rest of the argument is the value
+                return fillArgument(idx, i, ptr + seqLen);
             }
+            awaitValue(idx, i);
+            break;
+        }
+        const ParseResult res = fillArgument(idx, i, nullptr);
+        if (res != ParseResult::Parsed) {
+            return res;
+        }
+        ptr += seqLen;
+    }
+    return ParseResult::Parsed;
+}
+
+/**
+ * resolves long option name with the enabled matching rules
+ * @param name long option name without leading dashes
+ * @param bAmbiguous receives true when the abbreviated name matches several options
+ * @return options index or npos
+ */
+size_t ParseContext::lookupLong(std::string_view name, bool& bAmbiguous) const noexcept {
+    bAmbiguous = false;
+    return abbreviations ? pSchema->findPrefix(name, bAmbiguous) : pSchema->findLong(name);
+}
+
+/**
+ * fills the long option value in, the value follows '=' or is the next argument unless it starts with a dash
+ * @param idx options index
+ * @param i the option argument index
+ * @param pValue the value after '=' or nullptr
+ * @return parse result, ParseResult::Error for a flag option given a value
+ */
+ParseResult ParseContext::parseLong(size_t idx, size_t i, const char* pValue) {
+    const auto& rOpt = (*pSchema)[idx];
+    if (pValue != nullptr) {
+        if (rOpt.type == app::arguments::Type::None) {
+            return reject(ParseResult::Error, ErrorKind::UnexpectedValue, i);
         }
+        return fillArgument(idx, i, pValue);
+    }
+    if (rOpt.type != app::arguments::Type::None) {
+        awaitValue(idx, i);
+        return ParseResult::Parsed;
+    }
+    return fillArgument(idx, i, nullptr);
+}
+
+/**
+ * fills the option value in from an argument
+ * @param idx options index
+ * @param i the value argument index
+ * @param optArg the value or nullptr
+ * @return parse result, ParseResult::Error when the value does not meet the option
+ */
+ParseResult ParseContext::fillArgument(size_t idx, size_t i, const char* optArg) {
+    const auto res = fillIn(idx, (*pSchema)[idx], optArg);
+    if (res != app::arguments::ConvResult::Ok) {
+        return reject(ParseResult::Error, toErrorKind(res), i);
     }
     return ParseResult::Parsed;
 }
 
+/**
+ * completes the option waiting for its value without the value
+ * @return parse result, ParseResult::Error for a mandatory value
+ */
+ParseResult ParseContext::completeOption() {
+    streamState = StreamState::Options;
+    if ((*pSchema)[awaitingIdx].type == app::arguments::Type::Mandatory) {
+        return reject(ParseResult::Error, ErrorKind::MissingValue, awaitingArg);
+    }
+    setValue(awaitingIdx, true);
+    return ParseResult::Parsed;
+}
+
 /**
  * a non-throwing test for parameter availability
  * @param name a configuration parameter name
  * @return true, if there is a value
  */
-bool Config::hasValue(const std::string& name) const noexcept {
-    return  config.count(name) > 0;
+bool ParseContext::hasValue(const std::string& name) const noexcept {
+    return pSchema != nullptr && hasValue(app::arguments::OptionHandle(pSchema->findLong(name)));
 }
 
 /**
@@ -281,9 +1086,56 @@ bool Config::hasValue(const std::string& name) const noexcept {
  * @param name a configuration parameter name
  * @return value
  * @throws std::out_of_range when no parameter available
+ * @throws std::invalid_argument when lazy value cannot be converted
  */
-app::arguments::Value Config::getValue(const std::string& name) const {
-    return config.at(name);
+app::arguments::Value ParseContext::getValue(const std::string& name) const {
+    return getValueRef(name);
+}
+
+/**
+ * returns paramenter value without copying it. The reference is valid until the next parseArgs() call
+ * @param name a configuration parameter name
+ * @return value
+ * @throws std::out_of_range when no parameter available
+ * @throws std::invalid_argument when lazy value cannot be converted
+ */
+const app::arguments::Value& ParseContext::getValueRef(std::string_view name) const {
+    if (pSchema == nullptr) {
+        APP_THROW(std::out_of_range("ParseContext::getValueRef: no value"));
+    }
+    return getValue(app::arguments::OptionHandle(pSchema->findLong(name)));
+}
+
+/**
+ * returns paramenter value by a resolved option without copying it
+ * @param opt option handle of the parsed schema
+ * @return value
+ * @throws std::out_of_range when no parameter available
+ * @throws std::invalid_argument when lazy value cannot be converted
+ */
+const app::arguments::Value& ParseContext::getValue(const app::arguments::OptionHandle opt) const {
+    if (!hasValue(opt)) {
+        APP_THROW(std::out_of_range("ParseContext::getValue: no value"));
+    }
+    if (!resolve(opt.index)) {
+        APP_THROW(std::invalid_argument("ParseContext::getValue: invalid value"));
+    }
+    return values[opt.index];
+}
+
+/**
+ * returns string paramenter value without copying it, in both string storage modes
+ * @param name a configuration parameter name
+ * @return view of the value
+ * @throws std::out_of_range when no parameter available
+ * @throws std::bad_variant_access when the value is not a string
+ */
+std::string_view ParseContext::getString(std::string_view name) const {
+    const auto& val = getValueRef(name);
+    if (const auto* pView = std::get_if<app::arguments::BorrowedString>(&val)) {
+        return *pView;
+    }
+    return std::get<std::string>(val);
 }
 
 /**
@@ -293,7 +1145,7 @@ app::arguments::Value Config::getValue(const std::string& name) const {
  * @param out - an output stream receives the usage message
  * @return the output stream resulting state
  */
-std::ostream& Config::printHelp(const std::vector<app::arguments::Options>& optMap, const std::string& progName, std::ostream& out) {
+std::ostream& ParseContext::printHelp(const std::vector<app::arguments::Options>& optMap, const std::string& progName, std::ostream& out) {
     size_t pos = progName.rfind(std::filesystem::path::preferred_separator);
     out << std::endl << "Usage: " << std::endl;
     if (pos!=std::string::npos) {
@@ -302,13 +1154,49 @@ std::ostream& Config::printHelp(const std::vector<app::arguments::Options>& optM
     else {
         out << progName;
     }
-    out << " [options]" << std::endl << "Options:" << std::endl;
+    out << " [options]" << std::endl;
+    return printOptions(optMap, out);
+}
+
+/**
+ * prints the options part of usage help message
+ * @param optMap a configuration parameters options
+ * @param out - an output stream receives the options list
+ * @return the output stream resulting state
+ */
+std::ostream& ParseContext::printOptions(const std::vector<app::arguments::Options>& optMap, std::ostream& out) {
+    out << "Options:" << std::endl;
     for (const auto& opt: optMap) {
         out << '\t';
-        if (!::isspace(opt.shortCut) && opt.shortCut!='\0') {
+        if (!opt.shortUtf8.empty()) {
+            out << '-' << opt.shortUtf8 << " or ";
+        }
+        else if (!::isspace(opt.shortCut) && opt.shortCut!='\0') {
             out << '-' << opt.shortCut << " or ";
         }
         out << "--" << opt.name << " " << opt.desc;
+        if (opt.valueType == app::arguments::ValueType::Enum) {
+            out << ", one of:";
+            for (const auto& enumName : opt.enumNames) {
+                out << ' ' << enumName;
+            }
+        }
+        if (opt.minValue.has_value() || opt.maxValue.has_value()) {
+            const auto printBound = [&out](const app::arguments::DefaultValue& bound) {
+                if (bound.has_value()) {
+                    std::visit([&out](const auto& b) {
+                        typedef std::decay_t<decltype(b)> B;
+                        if constexpr (std::is_same_v<B, int32_t> || std::is_same_v<B, int64_t> || std::is_same_v<B, double>) {
+                            out << std::dec << b;
+                        }
+                    }, bound.value());
+                }
+            };
+            out << ", range: ";
+            printBound(opt.minValue);
+            out << "..";
+            printBound(opt.maxValue);
+        }
         if (opt.defaultValue.has_value()) {
             out << ", default: ";
             const auto& val = opt.defaultValue.value();
@@ -331,6 +1219,9 @@ std::ostream& Config::printHelp(const std::vector<app::arguments::Options>& optM
                 case app::arguments::ValueType::Int64h:
                     out << std::get<int64_t>(val);
                     break;
+                case app::arguments::ValueType::Enum:
+                    out << opt.enumNames[std::get<int32_t>(val)];
+                    break;
                 default:
                     out << '?';
                     break;
@@ -343,31 +1234,51 @@ std::ostream& Config::printHelp(const std::vector<app::arguments::Options>& optM
 
 /**
  * validates that configuration contains mandatory parameters
- * @param optMap a configuration parameters options
+ * @param optMap a configuration parameters options, must be the last parsed options
  * @return absent mandatory parameter option index or std::string::npos when all mandatory parameters have their values
  */
-size_t app::config::Config::valid(const std::vector<app::arguments::Options>& optMap)
+size_t app::config::ParseContext::valid(const std::vector<app::arguments::Options>& optMap)
 {
-    for (size_t i = 0; i < optMap.size(); i++) {
-        if (optMap[i].type != app::arguments::Type::Mandatory) {
-            continue; // if argument not mandatory - skip it
-        }
-        try
-        {
-            const auto& cfg = config.at(optMap[i].name);
-            if (optMap[i].defaultValue.has_value()) {
-                if (cfg.index() != optMap[i].defaultValue.value().index()) {
-                    return i; // value type not equal to default value type
-                }
+    if (pSchema == nullptr) {
+        // nothing was parsed, so every mandatory argument is absent
+        for (size_t i = 0; i < optMap.size(); i++) {
+            if (optMap[i].type == app::arguments::Type::Mandatory) {
+                return i;
             }
         }
-        catch (const std::out_of_range&)
-        {
-            return i; // argument not provided
+        return MANDATORY_PASSED_ALL;
+    }
+    return valid();
+}
+
+/**
+ * validates that configuration contains mandatory parameters of the last parsed schema
+ * @return absent mandatory parameter option index or std::string::npos when all mandatory parameters have their values
+ */
+size_t app::config::ParseContext::valid() const noexcept
+{
+    if (pSchema == nullptr) {
+        return MANDATORY_PASSED_ALL;
+    }
+    APP_STATS_PHASE(Validation);
+    const auto& mandatory = pSchema->mandatoryMask();
+    const auto& typed = pSchema->typedMask();
+    for (size_t w = 0; w < mandatory.size(); w++) {
+        app::arguments::MaskWord bad = mandatory[w] & ~present[w]; // argument not provided
+        app::arguments::MaskWord check = typed[w] & present[w];
+        if (pending) {
+            check &= ~pending[w].load(std::memory_order_acquire); // lazy values are checked on conversion
+        }
+        while (check != 0) {
+            const size_t bit = app::arguments::lowestBit(check);
+            const size_t i = w * app::arguments::MASK_WORD_BITS + bit;
+            if (!app::arguments::isSameType(values[i], (*pSchema)[i].defaultValue.value())) {
+                bad |= app::arguments::MaskWord(1) << bit; // value type not equal to default value type
+            }
+            check &= check - 1;
         }
-        catch (const std::exception&)
-        {
-            return i; // generic issue
+        if (bad != 0) {
+            return w * app::arguments::MASK_WORD_BITS + app::arguments::lowestBit(bad);
         }
     }
     // all required arguments were provided
@@ -4,11 +4,21 @@
 
 #ifndef Config_H
 #define Config_H
+#include <atomic>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 #include "appArguments.h"
+#include "appSchema.h"
+#include "appCommandString.h"
+#include "appConfigFile.h"
+#include "appNumeric.h"
+#include "appUtf8.h"
 
 namespace app::config {
 
@@ -18,36 +28,346 @@ namespace app::config {
         HelpRequired,
         Parsed,
         Unknown,
-        BadOptionIndex
+        BadOptionIndex,
+        Ambiguous, // abbreviated long option matches several options
+        BadEncoding // argument is not valid UTF-8 or wide character argument cannot be converted
     };
+    /**
+     * the reason of a failed parse, finer than ParseResult
+     */
+    enum class ErrorKind {
+        None = 0,
+        UnknownOption,
+        AmbiguousOption,
+        MissingValue, // option value is required
+        UnexpectedValue, // flag option given a value
+        BadValue, // value cannot be converted
+        OutOfRange, // number out of the option range
+        BadEncoding,
+        NullArgument, // argv element is nullptr
+        Unterminated, // command string quote is not closed
+    };
+    /**
+     * parse failure: the result, its reason and where it happened
+     */
+    class ParseError {
+    public:
+        ParseResult result;
+        ErrorKind kind;
+        size_t index; // argument index, configuration file line or environment entry index
+        size_t offset; // byte offset in the argument or in the command string
+    };
+    /**
+     * expected-like result of the exception-free parse: either success or ParseError
+     */
+    class ParseOutcome {
+    public:
+        ParseOutcome() noexcept : err{ ParseResult::Parsed, ErrorKind::None, 0, 0 } {};
+        explicit ParseOutcome(const ParseError& error) noexcept : err(error) {};
+        [[nodiscard]] bool has_value() const noexcept { return err.result == ParseResult::Parsed; }
+        explicit operator bool() const noexcept { return has_value(); }
+        /**
+         * @return the failure, ParseResult::Parsed and ErrorKind::None on success
+         */
+        [[nodiscard]] const ParseError& error() const noexcept { return err; }
+        [[nodiscard]] ParseResult result() const noexcept { return err.result; }
+    private:
+        ParseError err;
+    };
+    class Snapshot;
     //typedef struct option Option;
-    class Config {
+    /**
+     * parsed configuration of one command line. It does not share any state, so each thread may parse
+     * its own command lines with its own context concurrently.
+     * Values storage is allocated from the memory resource passed to the constructor. With a prebuilt schema
+     * and StringMode::Arena or StringMode::Borrow a parse makes no global heap allocations, e.g. over a stack buffer:
+     * <pre>
+     * char buf[4096];
+     * std::pmr::monotonic_buffer_resource arena(buf, sizeof(buf), std::pmr::null_memory_resource());
+     * ParseContext ctx(&arena);
+     * ctx.setStringMode(StringMode::Arena);
+     * ctx.parseArgs(argc, argv, schema);
+     * </pre>
+     * Parse errors are reported with status codes, nothing is thrown but std::bad_alloc, see tryParseArgs().
+     * In lazy mode values are converted on the first access, see setLazy()
+     */
+    class ParseContext {
     public:
         static constexpr const size_t MANDATORY_PASSED_ALL = -1;
-        Config(const Config&) = delete; // no copy constructor
-        Config& operator=(const Config&) = delete; // no assignment operator
-        Config(Config&&) = delete; // no move constructor
-        Config& operator=(Config&&) = delete;// no move assignment
-        static Config& getInstance() {
-            std::call_once(initFlag, []() {
-                instance.reset(new Config());
-            });
-            return *instance;
-        }
+        ParseContext() : ParseContext(std::pmr::get_default_resource()) {};
+        /**
+         * @param pResource values storage memory resource, it must outlive the context
+         */
+        explicit ParseContext(std::pmr::memory_resource* pResource) : badArgumentIndex(0), badArgumentOffset(0), lastParsed(0), operandIndex(0),
+            errorKind(ErrorKind::None), ownedSchema(), pSchema(nullptr), values(pResource), present(pResource), assigned(pResource),
+            appended(pResource), stringMode(app::arguments::StringMode::Copy), pResource(pResource), lazy(false), raw(pResource), pending(),
+            pendingWords(0), pConvertLock(), longOnly(false), abbreviations(false),
+            utf8Validation(false), stopAtOperand(false), wideArgs(), commandArgs(), streamState(StreamState::Idle), streamResult(ParseResult::None),
+            streamIndex(0), awaitingIdx(0), awaitingArg(0) {};
+        ParseContext(const ParseContext&) = delete; // no copy constructor
+        ParseContext& operator=(const ParseContext&) = delete; // no assignment operator
+        ParseContext(ParseContext&&) = default;
+        ParseContext& operator=(ParseContext&&) = default;
         ParseResult parseArgs(int argc, char** argv, const std::vector<app::arguments::Options>& optMap);
+        ParseResult parseArgs(int argc, char** argv, const app::arguments::ParserSchema& schema);
+        ParseResult parseArgs(int argc, char** argv, const app::arguments::ParserSchema& schema, const ConfigFile& file);
+        ParseResult parseArgs(int argc, char** argv, const app::arguments::ParserSchema& schema, char** envp);
+        ParseResult parseArgs(int argc, wchar_t** argv, const app::arguments::ParserSchema& schema);
+        ParseOutcome tryParseArgs(int argc, char** argv, const app::arguments::ParserSchema& schema) noexcept;
+        ParseResult parseCommand(char* pCommand, size_t size, const app::arguments::ParserSchema& schema);
+        /**
+         * splits a command line given as one string and parses it, see parseCommand(char*, size_t, const ParserSchema&)
+         * @param command command line, its content is overwritten
+         * @param schema compiled options to parse command line
+         * @return parse result
+         */
+        ParseResult parseCommand(std::string& command, const app::arguments::ParserSchema& schema) {
+            return parseCommand(command.data(), command.size(), schema);
+        }
+        void reset(const app::arguments::ParserSchema& schema);
+        ParseResult merge(const ConfigFile& file);
+        ParseResult mergeArgs(int argc, char** argv);
+        ParseResult mergeEnvironment(char** envp = nullptr);
+        ParseResult beginArgs();
+        ParseResult feed(const char* arg);
+        ParseResult finish();
+        /**
+         * @return true when the last streamed argument is an option waiting for its value
+         */
+        [[nodiscard]] bool isAwaitingValue() const noexcept { return streamState == StreamState::AwaitingValue; }
         [[nodiscard]] app::arguments::Value getValue(const std::string& name) const;
+        [[nodiscard]] const app::arguments::Value& getValueRef(std::string_view name) const;
+        [[nodiscard]] std::string_view getString(std::string_view name) const;
         [[nodiscard]] bool hasValue(const std::string& name) const noexcept;
+        /**
+         * a non-throwing test for parameter availability by a resolved option
+         * @param opt option handle of the parsed schema
+         * @return true, if there is a value
+         */
+        [[nodiscard]] bool hasValue(const app::arguments::OptionHandle opt) const noexcept {
+            return opt.index < values.size() && isPresent(opt.index);
+        }
+        /**
+         * returns parameter value by a resolved option without name lookup
+         * @param opt option handle of the parsed schema
+         * @return pointer to the value or nullptr when no parameter available
+         */
+        [[nodiscard]] const app::arguments::Value* find(const app::arguments::OptionHandle opt) const noexcept {
+            if (!hasValue(opt)) {
+                return nullptr;
+            }
+            APP_TRY {
+                return resolve(opt.index) ? &values[opt.index] : nullptr;
+            } APP_CATCH_ALL {
+                return nullptr;
+            }
+        }
+        [[nodiscard]] const app::arguments::Value& getValue(app::arguments::OptionHandle opt) const;
+        /**
+         * options which values were passed explicitly rather than taken from defaults, one bit per options index
+         */
+        [[nodiscard]] const std::pmr::vector<app::arguments::MaskWord>& assignedMask() const noexcept { return assigned; }
+        [[nodiscard]] std::pmr::memory_resource* getMemoryResource() const noexcept { return pResource; }
+        /**
+         * returns the schema used by the last parseArgs() call
+         * @return parsed schema or nullptr when nothing was parsed yet
+         */
+        [[nodiscard]] const app::arguments::ParserSchema* getSchema() const noexcept { return pSchema; }
+        /**
+         * selects string values storage. In StringMode::Borrow string values are views into argv
+         * (or into a caller-owned buffer passed as argv) and into the default values of the parsed schema,
+         * so argv and the schema must outlive the values. In StringMode::Arena strings are copied into
+         * the memory resource and only the schema must outlive the values
+         * @param mode string storage mode
+         */
+        void setStringMode(app::arguments::StringMode mode) noexcept { stringMode = mode; }
+        [[nodiscard]] app::arguments::StringMode getStringMode() const noexcept { return stringMode; }
+        /**
+         * selects lazy conversion, it takes effect on the next parse. Lazy parse records the raw argument of
+         * an option, the value is converted on the first access and cached, concurrent readers are safe.
+         * The raw arguments (argv, configuration file) must outlive the first access as in StringMode::Borrow.
+         * A value which cannot be converted is reported by the accessors, or by validateAll() for all values
+         * @param bLazy true for lazy conversion
+         */
+        void setLazy(bool bLazy) noexcept { lazy = bLazy; }
+        [[nodiscard]] bool isLazy() const noexcept { return lazy; }
+        size_t validateAll();
+        /**
+         * getopt_long_only mode: arguments starting with a single dash are matched against long names first.
+         * A single character argument which is a known short option and a word which matches no long name
+         * are parsed as short options
+         * @param bLongOnly true for getopt_long_only mode
+         */
+        void setLongOnly(bool bLongOnly) noexcept { longOnly = bLongOnly; }
+        [[nodiscard]] bool isLongOnly() const noexcept { return longOnly; }
+        /**
+         * allows unique prefixes of long names as in GNU getopt_long, "--out" resolves to "--output_directory".
+         * A prefix of several names makes parse fail with ParseResult::Ambiguous, an exact name always wins
+         * @param bAbbreviations true to allow abbreviations
+         */
+        void setAbbreviations(bool bAbbreviations) noexcept { abbreviations = bAbbreviations; }
+        [[nodiscard]] bool getAbbreviations() const noexcept { return abbreviations; }
+        /**
+         * validates command line arguments as UTF-8 before parsing them, an invalid argument fails the parse with
+         * ParseResult::BadEncoding and badArgumentOffset is the byte offset of the invalid sequence
+         * @param bValidate true to validate
+         */
+        void setUtf8Validation(bool bValidate) noexcept { utf8Validation = bValidate; }
+        [[nodiscard]] bool getUtf8Validation() const noexcept { return utf8Validation; }
+        /**
+         * stops parsing at the first operand as getopt does with a leading '+' in optstring, operandIndex receives
+         * its index. Subcommands use it to find the subcommand word after the global options
+         * @param bStop true to stop at the first operand
+         */
+        void setStopAtOperand(bool bStop) noexcept { stopAtOperand = bStop; }
+        [[nodiscard]] bool getStopAtOperand() const noexcept { return stopAtOperand; }
+        /**
+         * typed access to the value of compile-time option, no name lookup is performed.
+         * The arguments must be parsed with Schema::schema()
+         * @tparam Schema app::arguments::StaticSchema instance
+         * @tparam I option index, usually Schema::index("name")
+         * @return option value
+         * @throws std::out_of_range when no parameter available
+         * @throws std::bad_variant_access when optional parameter was passed without value
+         */
+        template <typename Schema, size_t I>
+        [[nodiscard]] typename Schema::template type<I> get() const {
+            static_assert(I < Schema::count, "unknown option");
+            if (I >= values.size() || !isPresent(I)) {
+                APP_THROW(std::out_of_range("ParseContext::get: no value"));
+            }
+            if (!resolve(I)) {
+                APP_THROW(std::invalid_argument("ParseContext::get: invalid value"));
+            }
+            typedef typename Schema::template type<I> T;
+            if constexpr (std::is_same_v<T, std::string_view>) {
+                if (const auto* pStr = std::get_if<std::string>(&values[I])) {
+                    return *pStr;
+                }
+                return std::get<app::arguments::BorrowedString>(values[I]);
+            }
+            else {
+                return std::get<std::remove_cv_t<std::remove_reference_t<T>>>(values[I]);
+            }
+        }
         static std::ostream& printHelp(const std::vector<app::arguments::Options>& optMap, const std::string& progName, std::ostream& out);
+        static std::ostream& printOptions(const std::vector<app::arguments::Options>& optMap, std::ostream& out);
         size_t  valid(const std::vector<app::arguments::Options>& optMap);
+        [[nodiscard]] size_t valid() const noexcept;
         size_t badArgumentIndex;
         size_t badArgumentOffset;
         size_t lastParsed;
+        size_t operandIndex; // the operand the parse stopped at in setStopAtOperand() mode, 0 when there was none
+        ErrorKind errorKind; // the reason of the last failed parse
+    protected:
+        friend class Snapshot;
+        std::unique_ptr<const app::arguments::ParserSchema> ownedSchema; // schema built from the options vector
+        const app::arguments::ParserSchema* pSchema; // the last parsed schema
+        mutable std::pmr::vector<app::arguments::Value> values; // values by options index, lazy values are converted on access
+        std::pmr::vector<app::arguments::MaskWord> present; // values presence bits by options index
+        std::pmr::vector<app::arguments::MaskWord> assigned; // explicitly passed values bits by options index
+        std::pmr::vector<app::arguments::MaskWord> appended; // list values bits of the running merge call
+        app::arguments::StringMode stringMode;
+        std::pmr::memory_resource* pResource; // values storage and StringMode::Arena strings
+        bool lazy;
+        std::pmr::vector<const char*> raw; // raw arguments of lazy values by options index
+        std::unique_ptr<std::atomic<app::arguments::MaskWord>[]> pending; // not converted lazy values bits, nullptr when not lazy
+        size_t pendingWords;
+        std::unique_ptr<std::mutex> pConvertLock; // serializes lazy conversions
+        bool longOnly;
+        bool abbreviations;
+        bool utf8Validation;
+        bool stopAtOperand;
+        std::unique_ptr<WideArguments> wideArgs; // converted arguments of the last wide character parse
+        std::unique_ptr<CommandString> commandArgs; // split arguments of the last command string parse
+        enum class StreamState {
+            Idle, // no arguments stream
+            Options, // the next argument is an option or an operand
+            AwaitingValue, // the next argument is the value of awaitingIdx unless it starts with a dash
+            Stopped, // "--" was passed, the next arguments are not parsed
+            Failed // the stream was rejected with streamResult
+        };
+        StreamState streamState;
+        ParseResult streamResult; // the stream result so far
+        size_t streamIndex; // the last streamed argument index
+        size_t awaitingIdx; // options index waiting for its value
+        size_t awaitingArg; // argument index of the option waiting for its value
+        [[nodiscard]] bool isPresent(size_t idx) const noexcept {
+            return (present[idx / app::arguments::MASK_WORD_BITS] >> (idx % app::arguments::MASK_WORD_BITS)) & 1;
+        }
+        app::arguments::ConvResult fillIn(size_t idx, const app::arguments::Options& opt, const char* optArg);
+        /**
+         * records the parse failure
+         * @param res failed result
+         * @param kind failure reason
+         * @param i argument index
+         * @return the failed result
+         */
+        ParseResult reject(ParseResult res, ErrorKind kind, size_t i) noexcept {
+            badArgumentIndex = i;
+            errorKind = kind;
+            return res;
+        }
+        size_t lookupLong(std::string_view name, bool& bAmbiguous) const noexcept;
+        ParseResult step(const char* arg);
+        ParseResult parseArgument(size_t i, const char* arg);
+        ParseResult parseLong(size_t idx, size_t i, const char* pValue);
+        ParseResult fillArgument(size_t idx, size_t i, const char* optArg);
+        ParseResult completeOption();
+        /**
+         * makes the option wait for its value in the next argument
+         * @param idx options index
+         * @param i the option argument index
+         */
+        void awaitValue(size_t idx, size_t i) noexcept {
+            streamState = StreamState::AwaitingValue;
+            awaitingIdx = idx;
+            awaitingArg = i;
+        }
+        void setValue(size_t idx, app::arguments::Value val);
+        app::arguments::BorrowedString arenaString(std::string_view str) const;
+        /**
+         * converts the lazy value if it was not converted yet
+         * @param idx options index
+         * @return false when the value cannot be converted
+         */
+        bool resolve(size_t idx) const {
+            if (!pending) {
+                return true;
+            }
+            const auto bits = pending[idx / app::arguments::MASK_WORD_BITS].load(std::memory_order_acquire);
+            return ((bits >> (idx % app::arguments::MASK_WORD_BITS)) & 1) == 0 || convert(idx);
+        }
+        bool convert(size_t idx) const;
+    };
+
+    /**
+     * process-wide parse context
+     */
+    class Config : public ParseContext {
+    public:
+        Config(const Config&) = delete; // no copy constructor
+        Config& operator=(const Config&) = delete; // no assignment operator
+        Config(Config&&) = delete; // no move constructor
+        Config& operator=(Config&&) = delete;// no move assignment
+        static Config& getInstance() {
+            return getInstance(std::pmr::get_default_resource());
+        }
+        /**
+         * returns the instance
+         * @param pResource values storage memory resource used when this call creates the instance
+         * @return process-wide parse context
+         */
+        static Config& getInstance(std::pmr::memory_resource* pResource) {
+            std::call_once(initFlag, [pResource]() {
+                instance.reset(new Config(pResource));
+            });
+            return *instance;
+        }
     private:
-        std::map<std::string,app::arguments::Value> config;
-        Config() : badArgumentIndex(0), badArgumentOffset(0), lastParsed(0), config() {};
+        explicit Config(std::pmr::memory_resource* pResource) : ParseContext(pResource) {};
         static std::unique_ptr<Config> instance;
         static std::once_flag initFlag;
-        void fillIn(const app::arguments::Options& opt, const char* optArg);
     };
 };
 
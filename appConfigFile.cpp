@@ -0,0 +1,77 @@
+//
+// Created by shtykov on 10/18/26.
+//
+#include "appConfigFile.h"
+
+#include <cstring>
+#include "appStats.h"
+using namespace app::config;
+
+static inline bool isBlank(const char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/**
+ * maps and tokenizes configuration file
+ * @param path configuration file path
+ * @return true when the file was read
+ */
+bool ConfigFile::load(const std::string& path) {
+    entries.clear();
+    if (!file.open(path)) {
+        return false;
+    }
+    tokenize();
+    return true;
+}
+
+/**
+ * splits the mapped file into entries in place, names and values are terminated with '\0'
+ */
+void ConfigFile::tokenize() {
+    APP_STATS_PHASE(Tokenize);
+    char* p = file.data();
+    char* const pEnd = p + file.size();
+    size_t line = 0;
+    while (p < pEnd) {
+        line ++;
+        char* pEol = static_cast<char*>(::memchr(p, '\n', pEnd - p));
+        if (pEol == nullptr) {
+            pEol = pEnd; // the mapping has '\0' there
+        }
+        char* pNext = pEol < pEnd ? pEol + 1 : pEnd;
+        char* pBegin = p;
+        while (pBegin < pEol && isBlank(*pBegin)) {
+            pBegin ++;
+        }
+        char* pStop = pEol;
+        while (pStop > pBegin && isBlank(pStop[-1])) {
+            pStop --;
+        }
+        p = pNext;
+        if (pBegin == pStop || *pBegin == '#' || *pBegin == ';') {
+            continue; // empty line or comment
+        }
+        char* pEq = static_cast<char*>(::memchr(pBegin, '=', pStop - pBegin));
+        if (pEq == nullptr) {
+            *pStop = '\0';
+            entries.push_back({ pBegin, nullptr, line });
+            continue;
+        }
+        char* pNameEnd = pEq;
+        while (pNameEnd > pBegin && isBlank(pNameEnd[-1])) {
+            pNameEnd --;
+        }
+        char* pValue = pEq + 1;
+        while (pValue < pStop && isBlank(*pValue)) {
+            pValue ++;
+        }
+        if (pStop - pValue >= 2 && *pValue == '"' && pStop[-1] == '"') {
+            pValue ++;
+            pStop --;
+        }
+        *pNameEnd = '\0';
+        *pStop = '\0';
+        entries.push_back({ pBegin, pValue, line });
+    }
+}
@@ -0,0 +1,36 @@
+//
+// Created by shtykov on 10/18/26.
+//
+
+#ifndef APP_CONFIG_FILE_H
+#define APP_CONFIG_FILE_H
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "appMappedFile.h"
+
+namespace app::config {
+    /**
+     * configuration file of "name = value" lines. Empty lines and lines starting with '#' or ';' are skipped,
+     * a line without '=' sets a flag. Values may be enclosed in double quotes to keep leading or trailing spaces.
+     * The file is memory-mapped and tokenized in place in one pass, names and values point into the mapping
+     */
+    class ConfigFile {
+    public:
+        class Entry {
+        public:
+            const char* name;
+            const char* value; // nullptr for a line without '='
+            size_t line; // 1-based line number
+        };
+        ConfigFile() : file(), entries() {};
+        bool load(const std::string& path);
+        [[nodiscard]] const std::vector<Entry>& getEntries() const noexcept { return entries; }
+    private:
+        MappedFile file;
+        std::vector<Entry> entries;
+        void tokenize();
+    };
+}
+
+#endif //APP_CONFIG_FILE_H
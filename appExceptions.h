@@ -0,0 +1,41 @@
+//
+// Created by shtykov on 10/18/26.
+//
+
+#ifndef APP_EXCEPTIONS_H
+#define APP_EXCEPTIONS_H
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * the library builds with and without exception support. The parse path reports errors with status codes; the
+ * remaining throwing calls (accessors of a missing value, invalid options) use these macros, which abort the process
+ * with the exception message when exceptions are disabled, e.g. with -fno-exceptions. APP_NO_EXCEPTIONS selects
+ * the same in code which is built with exceptions and links the library built without them
+ */
+#if (defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)) && !defined(APP_NO_EXCEPTIONS)
+#define APP_EXCEPTIONS 1
+#define APP_THROW(exception) throw exception
+#define APP_TRY try
+#define APP_CATCH_ALL catch (...)
+#else
+#define APP_EXCEPTIONS 0
+#define APP_THROW(exception) app::arguments::failFast(exception)
+#define APP_TRY if (true)
+#define APP_CATCH_ALL else
+#endif
+
+namespace app::arguments {
+    /**
+     * reports an error which would throw and aborts, used when exceptions are disabled
+     * @param error the exception which would be thrown
+     */
+    template <typename E>
+    [[noreturn]] void failFast(const E& error) noexcept {
+        std::fputs(error.what(), stderr);
+        std::fputc('\n', stderr);
+        std::abort();
+    }
+}
+
+#endif //APP_EXCEPTIONS_H
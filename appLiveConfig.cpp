@@ -0,0 +1,241 @@
+//
+// Created by shtykov on 10/18/26.
+//
+#include "appLiveConfig.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#define APP_HAVE_INOTIFY 1
+#endif
+using namespace app::config;
+
+/**
+ * stops watching and frees the snapshots, no reader may exist
+ */
+LiveConfig::~LiveConfig() {
+    stop();
+    delete current.load(std::memory_order_acquire);
+    for (const ConfigSnapshot* pSnapshot : retired) {
+        delete pSnapshot;
+    }
+    for (Slot* pSlot = slots.load(std::memory_order_acquire); pSlot != nullptr; ) {
+        Slot* pNext = pSlot->pNext;
+        delete pSlot;
+        pSlot = pNext;
+    }
+}
+
+/**
+ * protects the current snapshot with the reader hazard pointer, lock-free: the loop repeats only when
+ * a reload publishes in between
+ * @return guard of the current snapshot
+ */
+LiveConfig::ReadGuard LiveConfig::Reader::acquire() const noexcept {
+    const ConfigSnapshot* pSnapshot = pOwner->current.load(std::memory_order_acquire);
+    while (true) {
+        pSlot->hazard.store(pSnapshot, std::memory_order_seq_cst);
+        // the snapshot cannot be freed once the hazard is visible and it is still the current one
+        const ConfigSnapshot* pCheck = pOwner->current.load(std::memory_order_seq_cst);
+        if (pCheck == pSnapshot) {
+            return ReadGuard(pSlot, pSnapshot);
+        }
+        pSnapshot = pCheck;
+    }
+}
+
+/**
+ * creates a reading handle, a released slot is reused
+ * @return reader owning a hazard pointer slot
+ */
+LiveConfig::Reader LiveConfig::reader() {
+    for (Slot* pSlot = slots.load(std::memory_order_acquire); pSlot != nullptr; pSlot = pSlot->pNext) {
+        bool bUsed = false;
+        if (!pSlot->used.load(std::memory_order_relaxed) &&
+            pSlot->used.compare_exchange_strong(bUsed, true, std::memory_order_acq_rel)) {
+            return Reader(this, pSlot);
+        }
+    }
+    Slot* pSlot = new Slot();
+    Slot* pHead = slots.load(std::memory_order_relaxed);
+    do {
+        pSlot->pNext = pHead;
+    } while (!slots.compare_exchange_weak(pHead, pSlot, std::memory_order_release, std::memory_order_relaxed));
+    return Reader(this, pSlot);
+}
+
+/**
+ * parses the configuration file and then the command line and publishes the result. The arguments
+ * are kept for reload()
+ * @param argc argument count
+ * @param argv argument values, they must outlive the object
+ * @param path configuration file path
+ * @return parse result, ParseResult::Error when the file cannot be read or a mandatory value is absent
+ */
+ParseResult LiveConfig::load(int argc, char** argv, const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(writeLock);
+        this->argc = argc;
+        this->argv = argv;
+        this->path = path;
+    }
+    return reload();
+}
+
+/**
+ * parses the configuration again into a new snapshot and publishes it, the current snapshot stays
+ * published when the parse fails
+ * @return parse result, ParseResult::Error when the file cannot be read or a mandatory value is absent
+ */
+ParseResult LiveConfig::reload() {
+    std::lock_guard<std::mutex> lock(writeLock);
+    auto pSnapshot = std::make_unique<ConfigSnapshot>();
+    if (!pSnapshot->file.load(path)) {
+        return ParseResult::Error;
+    }
+    pSnapshot->ctx.setStringMode(mode);
+    ParseResult res;
+    if (argv != nullptr) {
+        res = pSnapshot->ctx.parseArgs(argc, argv, schema, pSnapshot->file);
+    }
+    else {
+        pSnapshot->ctx.reset(schema);
+        res = pSnapshot->ctx.merge(pSnapshot->file);
+    }
+    if (res != ParseResult::Parsed) {
+        return res;
+    }
+    if (pSnapshot->ctx.validateAll() != ParseContext::MANDATORY_PASSED_ALL) {
+        return ParseResult::Error;
+    }
+    publish(std::move(pSnapshot));
+    return ParseResult::Parsed;
+}
+
+/**
+ * swaps the snapshot in and frees the replaced snapshots nobody reads, the write lock is held
+ * @param pSnapshot new snapshot
+ */
+void LiveConfig::publish(std::unique_ptr<ConfigSnapshot> pSnapshot) {
+    pSnapshot->generation = generation.load(std::memory_order_relaxed) + 1;
+    const ConfigSnapshot* pOld = current.exchange(pSnapshot.release(), std::memory_order_seq_cst);
+    generation.fetch_add(1, std::memory_order_release);
+    if (pOld != nullptr) {
+        retired.push_back(pOld);
+    }
+    reclaim();
+}
+
+/**
+ * frees the retired snapshots which are not protected by a hazard pointer, the write lock is held
+ */
+void LiveConfig::reclaim() {
+    std::vector<const ConfigSnapshot*> hazards;
+    for (Slot* pSlot = slots.load(std::memory_order_acquire); pSlot != nullptr; pSlot = pSlot->pNext) {
+        const ConfigSnapshot* pHazard = pSlot->hazard.load(std::memory_order_seq_cst);
+        if (pHazard != nullptr) {
+            hazards.push_back(pHazard);
+        }
+    }
+    std::sort(hazards.begin(), hazards.end());
+    auto itKeep = std::partition(retired.begin(), retired.end(), [&hazards](const ConfigSnapshot* pSnapshot) {
+        return std::binary_search(hazards.begin(), hazards.end(), pSnapshot);
+    });
+    for (auto it = itKeep; it != retired.end(); ++it) {
+        delete *it;
+    }
+    retired.erase(itKeep, retired.end());
+}
+
+/**
+ * starts a thread reloading the configuration when the file is written or replaced. The file directory
+ * is watched, so editors replacing the file by rename are noticed too
+ * @return false when the platform has no inotify, nothing was loaded or the directory cannot be watched
+ */
+bool LiveConfig::watch() {
+#if defined(APP_HAVE_INOTIFY)
+    std::lock_guard<std::mutex> lock(writeLock);
+    if (watcher.joinable() || path.empty()) {
+        return watcher.joinable();
+    }
+    const int notifyFd = ::inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (notifyFd < 0) {
+        return false;
+    }
+    std::filesystem::path dir = std::filesystem::path(path).parent_path();
+    if (dir.empty()) {
+        dir = ".";
+    }
+    if (::inotify_add_watch(notifyFd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0 || ::pipe(stopFd) != 0) {
+        ::close(notifyFd);
+        return false;
+    }
+    watcher = std::thread(&LiveConfig::watchLoop, this, notifyFd, std::filesystem::path(path).filename().string());
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * stops the watcher thread
+ */
+void LiveConfig::stop() {
+#if defined(APP_HAVE_INOTIFY)
+    if (!watcher.joinable()) {
+        return;
+    }
+    const char stopByte = 0;
+    while (::write(stopFd[1], &stopByte, 1) < 0 && errno == EINTR) {
+    }
+    watcher.join();
+    ::close(stopFd[0]);
+    ::close(stopFd[1]);
+    stopFd[0] = stopFd[1] = -1;
+#endif
+}
+
+/**
+ * watcher thread body, reloads on the events of the configuration file name
+ * @param notifyFd inotify descriptor, closed on exit
+ * @param name configuration file name
+ */
+void LiveConfig::watchLoop(const int notifyFd, const std::string name) {
+#if defined(APP_HAVE_INOTIFY)
+    alignas(inotify_event) char buf[4096];
+    pollfd fds[2] = { { notifyFd, POLLIN, 0 }, { stopFd[0], POLLIN, 0 } };
+    while (true) {
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if ((fds[1].revents & POLLIN) != 0) {
+            break;
+        }
+        bool bChanged = false;
+        ssize_t len;
+        while ((len = ::read(notifyFd, buf, sizeof(buf))) > 0) {
+            for (char* p = buf; p < buf + len; ) {
+                const auto* pEvent = reinterpret_cast<const inotify_event*>(p);
+                if (pEvent->len != 0 && name == pEvent->name) {
+                    bChanged = true;
+                }
+                p += sizeof(inotify_event) + pEvent->len;
+            }
+        }
+        if (bChanged) {
+            reload(); // a broken file keeps the current snapshot
+        }
+    }
+    ::close(notifyFd);
+#else
+    (void)notifyFd;
+    (void)name;
+#endif
+}
@@ -0,0 +1,146 @@
+//
+// Created by shtykov on 10/18/26.
+//
+
+#ifndef APP_LIVE_CONFIG_H
+#define APP_LIVE_CONFIG_H
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "appConfig.h"
+#include "appConfigFile.h"
+
+namespace app::config {
+    /**
+     * immutable parsed configuration published by LiveConfig
+     */
+    class ConfigSnapshot {
+    public:
+        ConfigSnapshot() : file(), ctx(), generation(0) {};
+        [[nodiscard]] const ParseContext& context() const noexcept { return ctx; }
+        [[nodiscard]] uint64_t getGeneration() const noexcept { return generation; }
+    private:
+        friend class LiveConfig;
+        ConfigFile file; // parsed configuration file, borrowed strings point into it
+        ParseContext ctx;
+        uint64_t generation;
+    };
+
+    /**
+     * configuration shared by many threads and reloaded while they read it. Every reload parses into a new
+     * ConfigSnapshot which is published with an atomic pointer swap, a snapshot is never changed after it was
+     * published. Readers protect the snapshot they read with a hazard pointer, so they never block and never see
+     * a half-built state; a replaced snapshot is freed by a later reload once no reader holds it.
+     * StringMode::Borrow keeps strings in the file mapping, so the file must be replaced by rename, not rewritten. Usage:
+     * <pre>
+     * LiveConfig live(schema);
+     * live.load(argc, argv, "service.conf");
+     * live.watch(); // reloads on file changes
+     * // in every worker thread
+     * LiveConfig::Reader reader = live.reader();
+     * {
+     *     LiveConfig::ReadGuard cfg = reader.acquire();
+     *     int32_t level = std::get<int32_t>(cfg->getValueRef("level"));
+     * }
+     * </pre>
+     */
+    class LiveConfig {
+    private:
+        class Slot {
+        public:
+            std::atomic<const ConfigSnapshot*> hazard; // snapshot being read
+            std::atomic<bool> used; // owned by a reader
+            Slot* pNext;
+            Slot() : hazard(nullptr), used(true), pNext(nullptr) {};
+        };
+    public:
+        /**
+         * the snapshot protected from reclamation until the guard is destroyed
+         */
+        class ReadGuard {
+        public:
+            ReadGuard(const ReadGuard&) = delete; // no copy constructor
+            ReadGuard& operator=(const ReadGuard&) = delete; // no assignment operator
+            ReadGuard(ReadGuard&& other) noexcept : pSlot(other.pSlot), pSnapshot(other.pSnapshot) { other.pSlot = nullptr; };
+            ReadGuard& operator=(ReadGuard&&) = delete; // no move assignment
+            ~ReadGuard() {
+                if (pSlot != nullptr) {
+                    pSlot->hazard.store(nullptr, std::memory_order_release);
+                }
+            }
+            /**
+             * @return false when nothing was published yet
+             */
+            explicit operator bool() const noexcept { return pSnapshot != nullptr; }
+            [[nodiscard]] const ConfigSnapshot& snapshot() const noexcept { return *pSnapshot; }
+            const ParseContext* operator->() const noexcept { return &pSnapshot->context(); }
+            const ParseContext& operator*() const noexcept { return pSnapshot->context(); }
+        private:
+            friend class LiveConfig;
+            ReadGuard(Slot* pSlot, const ConfigSnapshot* pSnapshot) noexcept : pSlot(pSlot), pSnapshot(pSnapshot) {};
+            Slot* pSlot;
+            const ConfigSnapshot* pSnapshot;
+        };
+
+        /**
+         * per thread reading handle owning a hazard pointer slot, one ReadGuard of the reader may exist at a time
+         */
+        class Reader {
+        public:
+            Reader(const Reader&) = delete; // no copy constructor
+            Reader& operator=(const Reader&) = delete; // no assignment operator
+            Reader(Reader&& other) noexcept : pOwner(other.pOwner), pSlot(other.pSlot) { other.pSlot = nullptr; };
+            Reader& operator=(Reader&&) = delete; // no move assignment
+            ~Reader() {
+                if (pSlot != nullptr) {
+                    pSlot->used.store(false, std::memory_order_release);
+                }
+            }
+            [[nodiscard]] ReadGuard acquire() const noexcept;
+        private:
+            friend class LiveConfig;
+            Reader(const LiveConfig* pOwner, Slot* pSlot) noexcept : pOwner(pOwner), pSlot(pSlot) {};
+            const LiveConfig* pOwner;
+            Slot* pSlot;
+        };
+
+        explicit LiveConfig(const app::arguments::ParserSchema& schema,
+            app::arguments::StringMode mode = app::arguments::StringMode::Copy) :
+            schema(schema), mode(mode), current(nullptr), slots(nullptr), writeLock(), retired(), generation(0),
+            argc(0), argv(nullptr), path(), watcher(), stopFd{ -1, -1 } {};
+        LiveConfig(const LiveConfig&) = delete; // no copy constructor
+        LiveConfig& operator=(const LiveConfig&) = delete; // no assignment operator
+        ~LiveConfig();
+        ParseResult load(int argc, char** argv, const std::string& path);
+        ParseResult reload();
+        bool watch();
+        void stop();
+        [[nodiscard]] Reader reader();
+        /**
+         * @return the published snapshot generation, 0 when nothing was published
+         */
+        [[nodiscard]] uint64_t published() const noexcept { return generation.load(std::memory_order_acquire); }
+    private:
+        const app::arguments::ParserSchema& schema;
+        app::arguments::StringMode mode;
+        std::atomic<const ConfigSnapshot*> current;
+        std::atomic<Slot*> slots; // reader slots list, the slots are freed with the object
+        std::mutex writeLock; // serializes reloads
+        std::vector<const ConfigSnapshot*> retired; // replaced snapshots not freed yet
+        std::atomic<uint64_t> generation;
+        int argc;
+        char** argv; // command line arguments overriding the file, they must outlive the object
+        std::string path;
+        std::thread watcher;
+        int stopFd[2]; // wakes up the watcher thread
+        void publish(std::unique_ptr<ConfigSnapshot> pSnapshot);
+        void reclaim();
+        void watchLoop(int notifyFd, std::string name);
+    };
+}
+
+#endif //APP_LIVE_CONFIG_H
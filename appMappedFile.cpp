@@ -0,0 +1,98 @@
+//
+// Created by shtykov on 10/18/26.
+//
+#include "appMappedFile.h"
+
+#include <fstream>
+#include <iterator>
+#include <utility>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define APP_HAVE_MMAP 1
+#endif
+using namespace app::config;
+
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+    pData(std::exchange(other.pData, nullptr)), length(std::exchange(other.length, 0)),
+    mapped(std::exchange(other.mapped, 0)), buffer(std::move(other.buffer)) {
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        pData = std::exchange(other.pData, nullptr);
+        length = std::exchange(other.length, 0);
+        mapped = std::exchange(other.mapped, 0);
+        buffer = std::move(other.buffer);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+/**
+ * unmaps the file
+ */
+void MappedFile::close() noexcept {
+#if defined(APP_HAVE_MMAP)
+    if (mapped != 0) {
+        ::munmap(pData, mapped);
+    }
+#endif
+    pData = nullptr;
+    length = mapped = 0;
+    buffer.clear();
+}
+
+/**
+ * maps the file into memory
+ * @param path file path
+ * @return true when the file contents are available
+ */
+bool MappedFile::open(const std::string& path) {
+    close();
+#if defined(APP_HAVE_MMAP)
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        const size_t size = static_cast<size_t>(st.st_size);
+        // reserves zero-filled pages covering the file and the terminating '\0', then maps the file over them
+        const size_t region = (size + 1 + page - 1) / page * page;
+        void* pRegion = ::mmap(nullptr, region, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pRegion != MAP_FAILED) {
+            // no MAP_POPULATE: it would copy every page of a private writable mapping up front,
+            // only the pages written by the tokenizer are copied on demand
+            void* pFile = ::mmap(pRegion, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+            if (pFile != MAP_FAILED) {
+                ::madvise(pFile, size, MADV_WILLNEED); // reads the file ahead into the page cache without copying it
+                ::close(fd);
+                pData = static_cast<char*>(pFile);
+                length = size;
+                mapped = region;
+                return true;
+            }
+            ::munmap(pRegion, region);
+        }
+    }
+    ::close(fd);
+#endif
+    // no mmap() or not a regular file, reads it
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    length = buffer.size();
+    buffer.push_back('\0');
+    pData = buffer.data();
+    return true;
+}
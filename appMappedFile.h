@@ -0,0 +1,38 @@
+//
+// Created by shtykov on 10/18/26.
+//
+
+#ifndef APP_MAPPED_FILE_H
+#define APP_MAPPED_FILE_H
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace app::config {
+    /**
+     * a file mapped into memory copy-on-write, so the contents may be tokenized in place without
+     * touching the file. There is always a '\0' byte after the last file byte. Platforms without
+     * mmap() read the file into a heap buffer instead
+     */
+    class MappedFile {
+    public:
+        MappedFile() noexcept : pData(nullptr), length(0), mapped(0), buffer() {};
+        MappedFile(const MappedFile&) = delete; // no copy constructor
+        MappedFile& operator=(const MappedFile&) = delete; // no assignment operator
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        ~MappedFile();
+        bool open(const std::string& path);
+        void close() noexcept;
+        [[nodiscard]] char* data() const noexcept { return pData; }
+        [[nodiscard]] size_t size() const noexcept { return length; }
+        [[nodiscard]] bool isOpen() const noexcept { return pData != nullptr; }
+    private:
+        char* pData;
+        size_t length; // file size
+        size_t mapped; // mapped region size, 0 when the file was read into the buffer
+        std::vector<char> buffer;
+    };
+}
+
+#endif //APP_MAPPED_FILE_H
@@ -0,0 +1,276 @@
+//
+// Created by shtykov on 10/18/26.
+//
+#include "appNumeric.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define APP_HAVE_SSE2 1
+#endif
+using namespace app::arguments;
+
+/**
+ * splits the string at the delimiters in a single pass, 16 bytes are compared at a time when SSE2 is available
+ * @param str delimited values
+ * @param delimiter delimiter character
+ * @param onItem called for every item with its view, returns false to stop
+ * @return false when stopped
+ */
+template <typename F>
+static bool forEachItem(std::string_view str, const char delimiter, F onItem) {
+    const char* p = str.data();
+    const char* const pEnd = p + str.size();
+    const char* pItem = p;
+#if defined(APP_HAVE_SSE2)
+    const __m128i delim = _mm_set1_epi8(delimiter);
+    for (; pEnd - p >= 16; p += 16) {
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), delim)));
+        for (; mask != 0; mask &= mask - 1) {
+            const char* pDelim = p + __builtin_ctz(mask);
+            if (!onItem(std::string_view(pItem, pDelim - pItem))) {
+                return false;
+            }
+            pItem = pDelim + 1;
+        }
+    }
+#endif
+    for (; p < pEnd; p++) {
+        if (*p == delimiter) {
+            if (!onItem(std::string_view(pItem, p - pItem))) {
+                return false;
+            }
+            pItem = p + 1;
+        }
+    }
+    return onItem(std::string_view(pItem, pEnd - pItem));
+}
+
+/**
+ * counts the delimiters, the list is reserved with the count before splitting
+ * @param str delimited values
+ * @param delimiter delimiter character
+ * @return delimiters count
+ */
+size_t app::arguments::countDelimiters(std::string_view str, const char delimiter) noexcept {
+    const char* p = str.data();
+    const char* const pEnd = p + str.size();
+    size_t count = 0;
+#if defined(APP_HAVE_SSE2)
+    const __m128i delim = _mm_set1_epi8(delimiter);
+    for (; pEnd - p >= 16; p += 16) {
+        const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), delim));
+        count += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+    }
+#endif
+    for (; p < pEnd; p++) {
+        count += *p == delimiter;
+    }
+    return count;
+}
+
+/**
+ * returns the list held by the value, the value is replaced with an empty list when it holds another type
+ * @tparam L list type
+ * @param list value
+ * @return the list
+ */
+template <typename L>
+static L& listOf(Value& list) {
+    auto* pItems = std::get_if<L>(&list);
+    return pItems != nullptr ? *pItems : list.emplace<L>();
+}
+
+/**
+ * splits delimited numbers and appends them to the list
+ * @tparam T element type
+ * @param str delimited values, not empty
+ * @param list receives the elements
+ * @param convert element conversion
+ * @return conversion outcome of the first bad element or ConvResult::Ok
+ */
+template <typename T, typename F>
+static ConvResult appendNumbers(std::string_view str, Value& list, F convert) {
+    auto& items = listOf<std::vector<T>>(list);
+    items.reserve(items.size() + countDelimiters(str, LIST_DELIMITER) + 1);
+    ConvResult res = ConvResult::Ok;
+    forEachItem(str, LIST_DELIMITER, [&items, &res, &convert](std::string_view item) {
+        T val = 0;
+        res = convert(item, val);
+        if (res != ConvResult::Ok) {
+            return false;
+        }
+        items.push_back(val);
+        return true;
+    });
+    return res;
+}
+
+/**
+ * converts the whole string into a double value, locale independent and non-throwing
+ * @param str string to convert
+ * @param ret receives converted value, untouched on failure
+ * @return conversion outcome
+ */
+ConvResult app::arguments::toDouble(std::string_view str, double& ret) noexcept {
+    if (str.empty()) {
+        return ConvResult::Empty;
+    }
+    if (str[0] == '+') {
+        str.remove_prefix(1);
+        if (!str.empty() && (str[0] == '-' || str[0] == '+')) {
+            return ConvResult::Invalid; // "+-5"
+        }
+    }
+    double val;
+    const char* pEnd = str.data() + str.size();
+    const auto res = std::from_chars(str.data(), pEnd, val);
+    if (res.ec == std::errc::result_out_of_range) {
+        return ConvResult::Overflow;
+    }
+    if (res.ec != std::errc()) {
+        return ConvResult::Invalid;
+    }
+    if (res.ptr != pEnd) {
+        return ConvResult::Trailing;
+    }
+    ret = val;
+    return ConvResult::Ok;
+}
+
+/**
+ * converts string into a numeric value according to the value type
+ * @param str string to convert
+ * @param valueType one of the numeric value types
+ * @param ret receives converted value, untouched on failure
+ * @return conversion outcome
+ */
+ConvResult app::arguments::toValue(std::string_view str, const ValueType valueType, Value& ret) noexcept {
+    ConvResult res = ConvResult::NotNumeric;
+    switch (valueType) {
+        case ValueType::Int32:
+        case ValueType::Int32h: {
+            int32_t val = 0;
+            res = toInteger(str, valueType == ValueType::Int32h ? 16 : 10, val);
+            if (res == ConvResult::Ok) {
+                ret = val;
+            }
+            break;
+        }
+        case ValueType::Int64:
+        case ValueType::Int64h: {
+            int64_t val = 0;
+            res = toInteger(str, valueType == ValueType::Int64h ? 16 : 10, val);
+            if (res == ConvResult::Ok) {
+                ret = val;
+            }
+            break;
+        }
+        case ValueType::Float: {
+            double val = 0;
+            res = toDouble(str, val);
+            if (res == ConvResult::Ok) {
+                ret = val;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return res;
+}
+
+/**
+ * splits comma separated values and appends them to the list, the list is replaced when it holds another type.
+ * An empty string appends nothing
+ * @param str delimited values
+ * @param listType one of the list value types
+ * @param list receives the elements
+ * @return conversion outcome of the first bad element, the elements before it are appended
+ */
+ConvResult app::arguments::appendList(std::string_view str, const ValueType listType, Value& list) {
+    if (!isList(listType)) {
+        return ConvResult::NotNumeric;
+    }
+    const ValueType elemType = elementType(listType);
+    switch (elemType) {
+        case ValueType::Int32:
+        case ValueType::Int32h:
+            if (str.empty()) {
+                listOf<std::vector<int32_t>>(list);
+                return ConvResult::Ok;
+            }
+            if (elemType == ValueType::Int32h) {
+                return appendNumbers<int32_t>(str, list, [](std::string_view item, int32_t& val) {
+                    return toInteger(item, 16, val);
+                });
+            }
+            return appendNumbers<int32_t>(str, list, [](std::string_view item, int32_t& val) {
+                return toInteger(item, 10, val);
+            });
+        case ValueType::Int64:
+        case ValueType::Int64h:
+            if (str.empty()) {
+                listOf<std::vector<int64_t>>(list);
+                return ConvResult::Ok;
+            }
+            if (elemType == ValueType::Int64h) {
+                return appendNumbers<int64_t>(str, list, [](std::string_view item, int64_t& val) {
+                    return toInteger(item, 16, val);
+                });
+            }
+            return appendNumbers<int64_t>(str, list, [](std::string_view item, int64_t& val) {
+                return toInteger(item, 10, val);
+            });
+        case ValueType::Float:
+            if (str.empty()) {
+                listOf<std::vector<double>>(list);
+                return ConvResult::Ok;
+            }
+            return appendNumbers<double>(str, list, [](std::string_view item, double& val) {
+                return toDouble(item, val);
+            });
+        default: {
+            auto& items = listOf<StringList>(list);
+            if (str.empty()) {
+                return ConvResult::Ok;
+            }
+            items.reserve(countDelimiters(str, LIST_DELIMITER) + 1, str.size());
+            forEachItem(str, LIST_DELIMITER, [&items](std::string_view item) {
+                items.push_back(item);
+                return true;
+            });
+            return ConvResult::Ok;
+        }
+    }
+}
+
+/**
+ * describes conversion outcome
+ * @param res conversion outcome
+ * @return human-readable description
+ */
+const char* app::arguments::toString(const ConvResult res) noexcept {
+    switch (res) {
+        case ConvResult::Ok:
+            return "converted";
+        case ConvResult::Empty:
+            return "empty value";
+        case ConvResult::Invalid:
+            return "not a number";
+        case ConvResult::Trailing:
+            return "trailing characters after a number";
+        case ConvResult::Overflow:
+            return "number out of range";
+        case ConvResult::OutOfRange:
+            return "number out of the option range";
+        case ConvResult::NotName:
+            return "not an enumeration name";
+        case ConvResult::Missing:
+            return "required value not provided";
+        case ConvResult::NotList:
+            return "not a list value";
+        case ConvResult::NotNumeric:
+        default:
+            return "not a numeric value type";
+    }
+}
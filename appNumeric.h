@@ -0,0 +1,107 @@
+//
+// Created by shtykov on 10/18/26.
+//
+
+#ifndef APP_NUMERIC_H
+#define APP_NUMERIC_H
+#include <charconv>
+#include <limits>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include "appArguments.h"
+
+namespace app::arguments {
+    /**
+     * value conversion outcome
+     */
+    enum class ConvResult {
+        Ok = 0,
+        Empty, // nothing to convert
+        Invalid, // not a number
+        Trailing, // a number followed by garbage
+        Overflow, // a number does not fit the type
+        NotNumeric, // value type is not a numeric one
+        OutOfRange, // a number out of Options::minValue..Options::maxValue
+        NotName, // not an enumeration name
+        Missing, // required value not provided
+        NotList, // the option is not a list
+    };
+
+    /**
+     * converts the whole string into an integer, locale independent and non-throwing
+     * @param str string to convert, "0x" prefix is allowed for base 16 after an optional sign ("-0x1f")
+     * @param base 10 for human-readable integers or 16 for less readable integers
+     * @param ret receives converted value, untouched on failure
+     * @return conversion outcome
+     */
+    template <typename T>
+    ConvResult toInteger(std::string_view str, const int base, T& ret) noexcept {
+        if (str.empty()) {
+            return ConvResult::Empty;
+        }
+        const size_t original = str.size();
+        const bool bNegative = base == 16 && str.size() > 3 && str[0] == '-' && str[1] == '0' && (str[2] == 'x' || str[2] == 'X');
+        if (str[0] == '+' || bNegative) {
+            str.remove_prefix(1);
+        }
+        if (base == 16 && str.size() > 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X')) {
+            str.remove_prefix(2);
+        }
+        if (str.size() != original && !str.empty() && (str[0] == '-' || str[0] == '+')) {
+            return ConvResult::Invalid; // a sign after '+' or "0x", e.g. "+-5" or "0x-1f"
+        }
+        if (bNegative) {
+            // the magnitude is parsed unsigned and negated, "-0x80000000" is the least int32_t
+            typedef std::make_unsigned_t<T> Magnitude;
+            Magnitude magnitude;
+            const char* pEnd = str.data() + str.size();
+            const auto res = std::from_chars(str.data(), pEnd, magnitude, base);
+            if (res.ec == std::errc::result_out_of_range) {
+                return ConvResult::Overflow;
+            }
+            if (res.ec != std::errc()) {
+                return ConvResult::Invalid;
+            }
+            if (res.ptr != pEnd) {
+                return ConvResult::Trailing;
+            }
+            if constexpr (std::is_signed_v<T>) {
+                if (magnitude > static_cast<Magnitude>(std::numeric_limits<T>::max()) + 1) {
+                    return ConvResult::Overflow;
+                }
+                ret = magnitude == 0 ? T(0) : static_cast<T>(-static_cast<T>(magnitude - 1) - 1);
+            }
+            else {
+                if (magnitude != 0) {
+                    return ConvResult::Overflow;
+                }
+                ret = 0;
+            }
+            return ConvResult::Ok;
+        }
+        T val;
+        const char* pEnd = str.data() + str.size();
+        const auto res = std::from_chars(str.data(), pEnd, val, base);
+        if (res.ec == std::errc::result_out_of_range) {
+            return ConvResult::Overflow;
+        }
+        if (res.ec != std::errc()) {
+            return ConvResult::Invalid;
+        }
+        if (res.ptr != pEnd) {
+            return ConvResult::Trailing;
+        }
+        ret = val;
+        return ConvResult::Ok;
+    }
+
+    static constexpr const char LIST_DELIMITER = ',';
+    ConvResult toDouble(std::string_view str, double& ret) noexcept;
+    ConvResult toValue(std::string_view str, ValueType valueType, Value& ret) noexcept;
+    size_t countDelimiters(std::string_view str, char delimiter) noexcept;
+    ConvResult appendList(std::string_view str, ValueType listType, Value& list);
+    const char* toString(ConvResult res) noexcept;
+}
+
+#endif //APP_NUMERIC_H
@@ -0,0 +1,186 @@
+//
+// Created by shtykov on 10/18/26.
+//
+#include "appResponseFile.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+#include "appStats.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define APP_HAVE_SSE2 1
+#endif
+using namespace app::config;
+
+static inline bool isSpace(const char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline bool isBreak(const char c) {
+    return static_cast<unsigned char>(c) <= ' ' || c == '"' || c == '\'' || c == '\\';
+}
+
+/**
+ * finds the first byte which may end an argument: a control character, a space, a quote or a backslash
+ * @param p scan start
+ * @param pEnd scan end
+ * @return the found byte position or pEnd
+ */
+char* app::config::findArgumentBreak(char* p, char* const pEnd) noexcept {
+#if defined(APP_HAVE_SSE2)
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i dquote = _mm_set1_epi8('"');
+    const __m128i squote = _mm_set1_epi8('\'');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    for (; pEnd - p >= 16; p += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hit = _mm_cmpeq_epi8(_mm_min_epu8(chunk, space), chunk); // unsigned chunk <= ' '
+        hit = _mm_or_si128(hit, _mm_cmpeq_epi8(chunk, dquote));
+        hit = _mm_or_si128(hit, _mm_cmpeq_epi8(chunk, squote));
+        hit = _mm_or_si128(hit, _mm_cmpeq_epi8(chunk, backslash));
+        const int mask = _mm_movemask_epi8(hit);
+        if (mask != 0) {
+            return p + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+    }
+#endif
+    while (p < pEnd && !isBreak(*p)) {
+        p ++;
+    }
+    return p;
+}
+
+/**
+ * splits the next white space separated argument in place. Single and double quotes group white space into
+ * the argument, a backslash escapes the next character. The argument is terminated with '\0' written over
+ * the separator, so *pEnd must be writable
+ * @param p scan position, receives the position after the argument or the unterminated argument start
+ * @param pEnd scan end
+ * @param bUnterminated receives true when a quote was not closed
+ * @return the argument or nullptr when there are no more arguments
+ */
+char* app::config::nextArgument(char*& p, char* const pEnd, bool& bUnterminated) noexcept {
+    bUnterminated = false;
+    while (p < pEnd && isSpace(*p)) {
+        p ++;
+    }
+    if (p >= pEnd) {
+        return nullptr;
+    }
+    char* const pArg = p;
+    // fast path: plain arguments are only terminated, control characters other than spaces are plain ones
+    p = findArgumentBreak(p, pEnd);
+    while (p < pEnd && static_cast<unsigned char>(*p) < ' ' && !isSpace(*p)) {
+        p = findArgumentBreak(p + 1, pEnd);
+    }
+    char* pOut = p;
+    char quote = '\0';
+    // the arguments are compacted in place when quotes or escapes are removed
+    for (; p < pEnd; p ++) {
+        char c = *p;
+        if (quote != '\0') {
+            if (c == quote) {
+                quote = '\0';
+                continue;
+            }
+            if (c == '\\' && quote == '"' && p + 1 < pEnd) {
+                c = *++p;
+            }
+        }
+        else if (isSpace(c)) {
+            break;
+        }
+        else if (c == '"' || c == '\'') {
+            quote = c;
+            continue;
+        }
+        else if (c == '\\' && p + 1 < pEnd) {
+            c = *++p;
+        }
+        *pOut++ = c;
+    }
+    if (quote != '\0') {
+        p = pArg;
+        bUnterminated = true;
+        return nullptr;
+    }
+    *pOut = '\0';
+    if (p < pEnd) {
+        p ++;
+    }
+    return pArg;
+}
+
+/**
+ * expands response files found in the arguments, argv[0] is never expanded
+ * @param argc argument count
+ * @param argv argument values
+ * @return expansion result, badArgumentIndex and badArgumentOffset point to the failure
+ */
+ResponseFiles::Result ResponseFiles::expand(int argc, char** argv) {
+    APP_STATS_PHASE(Tokenize);
+    files.clear();
+    active.clear();
+    args.clear();
+    badArgumentIndex = badArgumentOffset = 0;
+    args.reserve(argc + 1);
+    for (int i = 0; i < argc; i++) {
+        if (i > 0 && argv[i] != nullptr && argv[i][0] == '@' && argv[i][1] != '\0') {
+            const Result res = expandFile(argv[i] + 1);
+            if (res != Result::Expanded) {
+                badArgumentIndex = i;
+                args.clear();
+                return res;
+            }
+        }
+        else {
+            args.push_back(argv[i]);
+        }
+    }
+    args.push_back(nullptr);
+    return Result::Expanded;
+}
+
+/**
+ * maps the response file and splits it into arguments in place
+ * @param path response file path
+ * @return expansion result
+ */
+ResponseFiles::Result ResponseFiles::expandFile(const char* path) {
+    std::error_code ec;
+    std::string canonical = std::filesystem::canonical(path, ec).string();
+    if (ec) {
+        return Result::OpenFailed;
+    }
+    if (std::find(active.begin(), active.end(), canonical) != active.end()) {
+        return Result::Recursion;
+    }
+    MappedFile file;
+    if (!file.open(canonical)) {
+        return Result::OpenFailed;
+    }
+    char* const pData = file.data();
+    char* const pEnd = pData + file.size();
+    files.push_back(std::move(file));
+    active.push_back(std::move(canonical));
+    char* p = pData;
+    bool bUnterminated = false;
+    while (char* pArg = nextArgument(p, pEnd, bUnterminated)) {
+        if (pArg[0] == '@' && pArg[1] != '\0') {
+            const Result res = expandFile(pArg + 1);
+            if (res != Result::Expanded) {
+                return res;
+            }
+        }
+        else {
+            args.push_back(pArg);
+        }
+    }
+    if (bUnterminated) {
+        badArgumentOffset = p - pData;
+        return Result::Unterminated;
+    }
+    active.pop_back();
+    return Result::Expanded;
+}
@@ -0,0 +1,47 @@
+//
+// Created by shtykov on 10/18/26.
+//
+
+#ifndef APP_RESPONSE_FILE_H
+#define APP_RESPONSE_FILE_H
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "appMappedFile.h"
+
+namespace app::config {
+    char* findArgumentBreak(char* p, char* pEnd) noexcept;
+    char* nextArgument(char*& p, char* pEnd, bool& bUnterminated) noexcept;
+
+    /**
+     * expands "@path" arguments with the arguments read from the response file. Response file arguments are
+     * separated by white space, single and double quotes group white space into an argument and a backslash
+     * escapes the next character. Nested response files are expanded too, a response file including itself
+     * directly or through other files is an error. The files are memory-mapped and split in place: the expanded
+     * argv points into the mappings, so the expander must outlive the parsed values in StringMode::Borrow
+     */
+    class ResponseFiles {
+    public:
+        enum class Result {
+            Expanded = 0,
+            OpenFailed, // response file cannot be read
+            Recursion, // response file includes itself
+            Unterminated, // quote is not closed
+        };
+        ResponseFiles() : badArgumentIndex(0), badArgumentOffset(0), files(), active(), args() {};
+        ResponseFiles(const ResponseFiles&) = delete; // no copy constructor
+        ResponseFiles& operator=(const ResponseFiles&) = delete; // no assignment operator
+        Result expand(int argc, char** argv);
+        [[nodiscard]] int argc() const noexcept { return args.empty() ? 0 : static_cast<int>(args.size() - 1); }
+        [[nodiscard]] char** argv() noexcept { return args.data(); }
+        size_t badArgumentIndex; // the top-level argument which expansion failed
+        size_t badArgumentOffset; // the byte offset in the failed response file
+    private:
+        std::vector<MappedFile> files; // keeps the mappings alive
+        std::vector<std::string> active; // canonical paths of the files being expanded
+        std::vector<char*> args; // expanded arguments followed by nullptr
+        Result expandFile(const char* path);
+    };
+}
+
+#endif //APP_RESPONSE_FILE_H
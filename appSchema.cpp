@@ -0,0 +1,281 @@
+//
+// Created by shtykov on 10/18/26.
+//
+#include "appSchema.h"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <utility>
+#include "appStats.h"
+using namespace app::arguments;
+
+/**
+ * builds lookup tables for the options vector
+ * @param optMap options to parse command line
+ */
+ParserSchema::ParserSchema(std::vector<Options> optMap) :
+    opts(std::move(optMap)), mandatory(maskWords(opts.size())), typed(maskWords(opts.size())), shortIndex(), trie(), trieEdges(), utf8Shorts(), envIndex(), envPrefixSize(0) {
+    APP_STATS_PHASE(SchemaBuild);
+    shortIndex.fill(npos);
+    std::vector<size_t> sorted;
+    sorted.reserve(opts.size());
+    for (size_t i = 0; i < opts.size(); i++) {
+        if (opts[i].type == Type::Mandatory) {
+            const MaskWord bit = MaskWord(1) << (i % MASK_WORD_BITS);
+            mandatory[i / MASK_WORD_BITS] |= bit;
+            if (opts[i].defaultValue.has_value()) {
+                typed[i / MASK_WORD_BITS] |= bit;
+            }
+        }
+        const unsigned char sc = static_cast<unsigned char>(opts[i].shortCut);
+        // the first option wins when several options share the same shortcut
+        if (sc != '\0' && !::isspace(sc) && shortIndex[sc] == npos) {
+            shortIndex[sc] = i;
+        }
+        sorted.push_back(i);
+        if (!opts[i].shortUtf8.empty()) {
+            utf8Shorts.push_back(i);
+        }
+        if (!opts[i].envName.empty()) {
+            envIndex.push_back(i);
+        }
+        if (opts[i].valueType == ValueType::Enum) {
+            opts[i].enumIndex.build(opts[i].enumNames);
+        }
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [this](size_t l, size_t r) {
+        return opts[l].name < opts[r].name;
+    });
+    trie.push_back({ 0, 0, npos, npos });
+    buildTrie(0, sorted, 0, sorted.size(), 0);
+    std::stable_sort(utf8Shorts.begin(), utf8Shorts.end(), [this](size_t l, size_t r) {
+        return opts[l].shortUtf8 < opts[r].shortUtf8;
+    });
+    std::stable_sort(envIndex.begin(), envIndex.end(), [this](size_t l, size_t r) {
+        return opts[l].envName < opts[r].envName;
+    });
+    if (!envIndex.empty()) {
+        // the first and the last names share the prefix common to all the sorted names
+        const std::string& first = opts[envIndex.front()].envName;
+        const std::string& last = opts[envIndex.back()].envName;
+        while (envPrefixSize < first.size() && envPrefixSize < last.size() && first[envPrefixSize] == last[envPrefixSize]) {
+            envPrefixSize ++;
+        }
+    }
+}
+
+/**
+ * FNV-1a hash of the name with a murmur3 finalizer, the seed selects another hash function of the family
+ * @param name string to hash
+ * @param seed hash function selector
+ * @return 32-bit hash
+ */
+uint32_t EnumIndex::hash(std::string_view name, const uint32_t seed) noexcept {
+    uint32_t h = 2166136261u ^ seed;
+    for (const char c : name) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+/**
+ * searches for the seed putting every name into its own slot, the table grows when no seed of a few
+ * dozens does. Enumerations are small, so the search ends within microseconds.
+ * The first name wins when several names are the same
+ * @param names enumeration names
+ */
+void EnumIndex::build(const std::vector<std::string>& names) {
+    seed = mask = 0;
+    slots.clear();
+    if (names.empty()) {
+        return;
+    }
+    size_t size = 2;
+    while (size < names.size() * 2) {
+        size <<= 1;
+    }
+    std::vector<int32_t> table;
+    for (;; size <<= 1) {
+        for (uint32_t s = 1; s <= 64; s++) {
+            table.assign(size, -1);
+            bool bPerfect = true;
+            for (size_t i = 0; i < names.size() && bPerfect; i++) {
+                int32_t& slot = table[hash(names[i], s) & (size - 1)];
+                if (slot < 0) {
+                    slot = static_cast<int32_t>(i);
+                }
+                else if (names[slot] != names[i]) {
+                    bPerfect = false;
+                }
+            }
+            if (bPerfect) {
+                seed = s;
+                mask = static_cast<uint32_t>(size - 1);
+                slots = std::move(table);
+                return;
+            }
+        }
+    }
+}
+
+/**
+ * resolves enumeration name
+ * @param name the name to find
+ * @param names enumeration names the index was built for
+ * @return name index or -1 when the name is not an enumeration name
+ */
+int32_t EnumIndex::find(std::string_view name, const std::vector<std::string>& names) const noexcept {
+    if (slots.empty()) {
+        return -1;
+    }
+    const int32_t idx = slots[hash(name, seed) & mask];
+    return idx >= 0 && names[idx] == name ? idx : -1;
+}
+
+/**
+ * builds the trie node of the names sharing the same prefix, the node children are appended contiguously
+ * before their subtrees are built
+ * @param node node index
+ * @param sorted options indexes sorted by name
+ * @param lo the first name of the node
+ * @param hi the name after the last name of the node
+ * @param depth prefix length
+ */
+void ParserSchema::buildTrie(const uint32_t node, const std::vector<size_t>& sorted, size_t lo, const size_t hi, const size_t depth) {
+    size_t names = 0;
+    if (lo < hi && opts[sorted[lo]].name.size() == depth) {
+        // the first option wins when several options share the same name
+        trie[node].option = trie[node].unique = sorted[lo];
+        names = 1;
+        while (lo < hi && opts[sorted[lo]].name.size() == depth) {
+            lo ++;
+        }
+    }
+    std::vector<std::pair<size_t, size_t>> groups; // names ranges by the next character
+    for (size_t i = lo; i < hi; ) {
+        const char c = opts[sorted[i]].name[depth];
+        size_t j = i + 1;
+        while (j < hi && opts[sorted[j]].name[depth] == c) {
+            j ++;
+        }
+        groups.emplace_back(i, j);
+        i = j;
+    }
+    const uint32_t firstEdge = static_cast<uint32_t>(trieEdges.size());
+    trie[node].firstEdge = firstEdge;
+    trie[node].edgeCount = static_cast<uint32_t>(groups.size());
+    for (const auto& group : groups) {
+        trieEdges.push_back({ static_cast<unsigned char>(opts[sorted[group.first]].name[depth]), static_cast<uint32_t>(trie.size()) });
+        trie.push_back({ 0, 0, npos, npos });
+    }
+    for (size_t g = 0; g < groups.size(); g++) {
+        const uint32_t child = trieEdges[firstEdge + g].child;
+        buildTrie(child, sorted, groups[g].first, groups[g].second, depth + 1);
+        // a child subtree without unique option has two or more names
+        names += trie[child].unique != npos ? 1 : 2;
+        if (names == 1) {
+            trie[node].unique = trie[child].unique;
+        }
+    }
+    if (names > 1) {
+        trie[node].unique = npos;
+    }
+}
+
+/**
+ * walks the trie along the name
+ * @param name long option name or its prefix
+ * @return node index or npos when no long name starts with the name
+ */
+size_t ParserSchema::walk(std::string_view name) const noexcept {
+    size_t node = 0;
+    for (const char c : name) {
+        const auto& rNode = trie[node];
+        const auto pBegin = trieEdges.begin() + rNode.firstEdge;
+        const auto pEnd = pBegin + rNode.edgeCount;
+        const unsigned char label = static_cast<unsigned char>(c);
+        auto it = std::lower_bound(pBegin, pEnd, label, [](const TrieEdge& edge, unsigned char key) {
+            return edge.label < key;
+        });
+        if (it == pEnd || it->label != label) {
+            return npos;
+        }
+        node = it->child;
+    }
+    return node;
+}
+
+/**
+ * resolves long option name into options index
+ * @param name long option name without leading dashes
+ * @return options index or npos when there is no such long option
+ */
+size_t ParserSchema::findLong(std::string_view name) const noexcept {
+    const size_t node = walk(name);
+    return node != npos ? trie[node].option : npos;
+}
+
+/**
+ * resolves long option name or its unique prefix into options index, an exact name wins over longer names
+ * @param name long option name or its prefix without leading dashes
+ * @param bAmbiguous receives true when the prefix starts several names
+ * @return options index or npos when there is no such long option or the prefix is ambiguous
+ */
+size_t ParserSchema::findPrefix(std::string_view name, bool& bAmbiguous) const noexcept {
+    bAmbiguous = false;
+    const size_t node = name.empty() ? npos : walk(name);
+    if (node == npos) {
+        return npos;
+    }
+    const auto& rNode = trie[node];
+    if (rNode.option != npos) {
+        return rNode.option;
+    }
+    bAmbiguous = rNode.unique == npos;
+    return rNode.unique;
+}
+
+/**
+ * resolves multi-byte short option into options index
+ * @param sequence UTF-8 sequence of the short option
+ * @return options index or npos when there is no such short option
+ */
+size_t ParserSchema::findShort(std::string_view sequence) const noexcept {
+    auto it = std::lower_bound(utf8Shorts.begin(), utf8Shorts.end(), sequence, [this](size_t idx, std::string_view key) {
+        return opts[idx].shortUtf8 < key;
+    });
+    return it != utf8Shorts.end() && opts[*it].shortUtf8 == sequence ? *it : npos;
+}
+
+/**
+ * resolves environment variable name into options index
+ * @param envName environment variable name
+ * @return options index or npos when no option reads the variable
+ */
+size_t ParserSchema::findEnv(std::string_view envName) const noexcept {
+    auto it = std::lower_bound(envIndex.begin(), envIndex.end(), envName, [this](size_t idx, std::string_view key) {
+        return opts[idx].envName < key;
+    });
+    return it != envIndex.end() && opts[*it].envName == envName ? *it : npos;
+}
+
+/**
+ * resolves long option name into a handle, intended to be called once at start-up
+ * @param name long option name
+ * @return option handle
+ * @throws std::out_of_range when there is no such option
+ */
+OptionHandle ParserSchema::handle(std::string_view name) const {
+    const size_t idx = findLong(name);
+    if (idx == npos) {
+        APP_THROW(std::out_of_range("ParserSchema::handle: unknown option"));
+    }
+    return OptionHandle(idx);
+}
@@ -0,0 +1,120 @@
+//
+// Created by shtykov on 10/18/26.
+//
+
+#ifndef APP_SCHEMA_H
+#define APP_SCHEMA_H
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "appArguments.h"
+
+namespace app::arguments {
+    typedef uint64_t MaskWord;
+    static constexpr const size_t MASK_WORD_BITS = 64;
+    /**
+     * computes the number of mask words required to store the bits
+     * @param bits number of bits
+     * @return number of mask words
+     */
+    constexpr size_t maskWords(size_t bits) noexcept {
+        return (bits + MASK_WORD_BITS - 1) / MASK_WORD_BITS;
+    }
+    /**
+     * finds the lowest set bit
+     * @param word a non-zero mask word
+     * @return the lowest set bit index
+     */
+    inline size_t lowestBit(MaskWord word) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<size_t>(__builtin_ctzll(word));
+#else
+        size_t ret = 0;
+        while ((word & 1) == 0) {
+            word >>= 1;
+            ret ++;
+        }
+        return ret;
+#endif
+    }
+
+    /**
+     * a resolved option, reads the option value with a single array access
+     */
+    class OptionHandle {
+    public:
+        size_t index;
+        constexpr explicit OptionHandle(size_t idx) noexcept : index(idx) {};
+    };
+
+    /**
+     * options vector compiled into lookup tables. Build it once and pass it to every parseArgs() call
+     * instead of rebuilding the shortcut buffer and the long names map per call.
+     * Long names are kept in a prefix trie with the children of a node stored contiguously, so exact and
+     * abbreviated lookups take O(name length)
+     */
+    class ParserSchema {
+    public:
+        static constexpr const size_t npos = static_cast<size_t>(-1);
+        explicit ParserSchema(std::vector<Options> optMap);
+        [[nodiscard]] const std::vector<Options>& options() const noexcept { return opts; }
+        [[nodiscard]] size_t size() const noexcept { return opts.size(); }
+        [[nodiscard]] const Options& operator[](size_t idx) const noexcept { return opts[idx]; }
+        /**
+         * resolves short option into options index
+         * @param sc short option character
+         * @return options index or npos when there is no such short option
+         */
+        [[nodiscard]] size_t findShort(const char sc) const noexcept {
+            return shortIndex[static_cast<unsigned char>(sc)];
+        }
+        [[nodiscard]] size_t findShort(std::string_view sequence) const noexcept;
+        [[nodiscard]] size_t findLong(std::string_view name) const noexcept;
+        [[nodiscard]] size_t findPrefix(std::string_view name, bool& bAmbiguous) const noexcept;
+        [[nodiscard]] OptionHandle handle(std::string_view name) const;
+        [[nodiscard]] size_t findEnv(std::string_view envName) const noexcept;
+        /**
+         * the common prefix of the environment variable names, an environment entry without it maps to no option
+         */
+        [[nodiscard]] std::string_view envPrefix() const noexcept {
+            return envIndex.empty() ? std::string_view() : std::string_view(opts[envIndex.front()].envName).substr(0, envPrefixSize);
+        }
+        [[nodiscard]] bool hasEnvironment() const noexcept { return !envIndex.empty(); }
+        /**
+         * mandatory options bit mask, one bit per options index
+         */
+        [[nodiscard]] const std::vector<MaskWord>& mandatoryMask() const noexcept { return mandatory; }
+        /**
+         * mandatory options having default value, their value type must match the default value type
+         */
+        [[nodiscard]] const std::vector<MaskWord>& typedMask() const noexcept { return typed; }
+    private:
+        class TrieEdge {
+        public:
+            unsigned char label;
+            uint32_t child; // node index
+        };
+        class TrieNode {
+        public:
+            uint32_t firstEdge; // children edges sorted by label
+            uint32_t edgeCount;
+            size_t option; // option named by the path to the node or npos
+            size_t unique; // the only option named by the node subtree or npos
+        };
+        std::vector<Options> opts;
+        std::vector<MaskWord> mandatory;
+        std::vector<MaskWord> typed;
+        std::array<size_t, 256> shortIndex; // direct shortcut table
+        std::vector<TrieNode> trie; // long names trie, the root is the first node
+        std::vector<TrieEdge> trieEdges;
+        std::vector<size_t> utf8Shorts; // options having multi-byte short option sorted by the option
+        std::vector<size_t> envIndex; // options having environment variable sorted by the variable name
+        size_t envPrefixSize; // common prefix length of the variable names
+        void buildTrie(uint32_t node, const std::vector<size_t>& sorted, size_t lo, size_t hi, size_t depth);
+        [[nodiscard]] size_t walk(std::string_view name) const noexcept;
+    };
+}
+
+#endif //APP_SCHEMA_H
@@ -0,0 +1,403 @@
+//
+// Created by shtykov on 10/18/26.
+//
+#include "appSnapshot.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <system_error>
+#include <vector>
+#if defined(_WIN32)
+#include <stdlib.h>
+#else
+extern char** environ;
+#endif
+using namespace app::config;
+
+namespace {
+    const uint32_t MAGIC = 0x53504f47; // "GOPS", also rejects snapshots of the other byte order
+
+    class Header {
+    public:
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint32_t count; // records count, the schema size
+        uint32_t lastParsed;
+        uint64_t stringsSize; // strings blob size
+    };
+
+    /**
+     * value of one option. Strings are stored in the blob after the records, '\0' terminated.
+     * Lists are stored in the blob as the raw elements, string lists as their '\0' terminated elements
+     */
+    class Record {
+    public:
+        enum : uint8_t {
+            Present = 1,
+            Assigned = 2
+        };
+        uint8_t flags;
+        uint8_t kind; // Value index, borrowed strings are stored as strings
+        uint16_t reserved;
+        uint32_t length; // string length or list size in bytes
+        uint64_t payload; // number bits or string and list offset in the blob
+    };
+
+    /**
+     * word at a time multiplicative hash, the inputs are hashed on every start so they are not hashed byte by byte
+     */
+    class Hasher {
+    public:
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        void mix(uint64_t word) noexcept {
+            hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL;
+            hash ^= hash >> 32;
+        }
+        void add(const void* p, size_t size) noexcept {
+            const auto* pByte = static_cast<const unsigned char*>(p);
+            uint64_t word = 0;
+            for (; size >= sizeof(word); size -= sizeof(word), pByte += sizeof(word)) {
+                std::memcpy(&word, pByte, sizeof(word));
+                mix(word);
+            }
+            word = 0;
+            std::memcpy(&word, pByte, size);
+            mix(word ^ (static_cast<uint64_t>(size) << 56));
+        }
+        template <typename T>
+        void add(const T& val) noexcept {
+            add(&val, sizeof(val));
+        }
+        void add(const char* pStr) noexcept {
+            if (pStr == nullptr) {
+                add(uint8_t(0xff));
+                return;
+            }
+            add(pStr, std::strlen(pStr) + 1);
+        }
+        void addString(std::string_view str) noexcept {
+            add(uint64_t(str.size()));
+            add(str.data(), str.size());
+        }
+    };
+
+    inline bool testBit(const std::pmr::vector<app::arguments::MaskWord>& mask, size_t idx) {
+        return (mask[idx / app::arguments::MASK_WORD_BITS] >> (idx % app::arguments::MASK_WORD_BITS)) & 1;
+    }
+
+    const uint8_t LIST_KIND = 6; // Value index of the first list
+
+    /**
+     * tests the record value kind, borrowed strings are stored as strings
+     */
+    inline bool isKnownKind(uint8_t kind) noexcept {
+        return kind <= 4 || (kind >= LIST_KIND && kind <= LIST_KIND + 3);
+    }
+
+    /**
+     * size of the numeric list element of the record value kind
+     * @return element size, 1 for strings and string lists
+     */
+    inline size_t elementSize(uint8_t kind) noexcept {
+        return kind == LIST_KIND ? sizeof(int32_t) : kind == LIST_KIND + 1 ? sizeof(int64_t) :
+            kind == LIST_KIND + 2 ? sizeof(double) : 1;
+    }
+
+    /**
+     * copies the list elements out of the blob, they are not aligned
+     */
+    template <typename T>
+    std::vector<T> loadNumbers(const char* p, size_t size) {
+        std::vector<T> items(size / sizeof(T));
+        std::memcpy(items.data(), p, items.size() * sizeof(T));
+        return items;
+    }
+}
+
+/**
+ * computes the snapshot key of the parse inputs
+ * @param schema compiled options
+ * @param ctx the context to parse with, its settings changing parse results are hashed
+ * @param argc argument count
+ * @param argv argument values
+ * @param configPath configuration file applied before the arguments or an empty string
+ * @param envp environment block passed to parseArgs(), nullptr for the process environment.
+ * The variables of the schema options are hashed with their values, the others are skipped
+ * @return snapshot key
+ */
+uint64_t Snapshot::makeKey(const app::arguments::ParserSchema& schema, const ParseContext& ctx, int argc, char** argv,
+    const std::string& configPath, char** envp) {
+    Hasher h;
+    h.add(VERSION);
+    h.add(uint8_t((ctx.getAbbreviations() ? 1 : 0) | (ctx.isLongOnly() ? 2 : 0) | (ctx.getStopAtOperand() ? 4 : 0) |
+        (ctx.getUtf8Validation() ? 8 : 0)));
+    h.add(uint64_t(schema.size()));
+    for (const auto& opt : schema.options()) {
+        h.addString(opt.name);
+        h.add(opt.shortCut);
+        h.addString(opt.shortUtf8);
+        h.add(opt.type);
+        h.add(opt.valueType);
+        h.addString(opt.envName);
+        h.add(uint64_t(opt.enumNames.size()));
+        for (const auto& enumName : opt.enumNames) {
+            h.addString(enumName);
+        }
+        for (const auto* pValue : { &opt.defaultValue, &opt.minValue, &opt.maxValue }) {
+            h.add(uint8_t(pValue->has_value() ? (*pValue)->index() : 0xff));
+            if (!pValue->has_value()) {
+                continue;
+            }
+            std::visit([&h](const auto& val) {
+                typedef std::decay_t<decltype(val)> T;
+                if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, app::arguments::BorrowedString>) {
+                    h.addString(val);
+                }
+                else if constexpr (std::is_same_v<T, app::arguments::StringList>) {
+                    h.addString(val.buffer());
+                }
+                else if constexpr (std::is_class_v<T>) {
+                    h.add(uint64_t(val.size()));
+                    h.add(val.data(), val.size() * sizeof(typename T::value_type));
+                }
+                else {
+                    h.add(val);
+                }
+            }, pValue->value());
+        }
+    }
+    h.add(argc);
+    for (int i = 0; i < argc; i++) {
+        h.add(argv[i]);
+    }
+    if (!configPath.empty()) {
+        std::error_code ec;
+        h.addString(configPath);
+        h.add(uint64_t(std::filesystem::file_size(configPath, ec)));
+        h.add(int64_t(std::filesystem::last_write_time(configPath, ec).time_since_epoch().count()));
+    }
+    if (schema.hasEnvironment()) {
+        if (envp == nullptr) {
+#if defined(_WIN32)
+            envp = _environ;
+#else
+            envp = environ;
+#endif
+        }
+        // the variables are resolved as ParseContext::mergeEnvironment() does
+        const std::string_view prefix = schema.envPrefix();
+        for (size_t i = 0; envp != nullptr && envp[i] != nullptr; i++) {
+            const char* pEntry = envp[i];
+            if (std::strncmp(pEntry, prefix.data(), prefix.size()) != 0) {
+                continue;
+            }
+            const char* pValue = std::strchr(pEntry + prefix.size(), '=');
+            if (pValue == nullptr) {
+                continue;
+            }
+            const size_t idx = schema.findEnv(std::string_view(pEntry, pValue - pEntry));
+            if (idx != app::arguments::ParserSchema::npos) {
+                h.add(uint64_t(idx));
+                h.add(pValue + 1);
+            }
+        }
+    }
+    return h.hash;
+}
+
+/**
+ * writes the parsed values. The snapshot is written to a temporary file and renamed over the path,
+ * so concurrent starts never map a partially written snapshot
+ * @param path snapshot path
+ * @param key snapshot key from makeKey()
+ * @param ctx parsed context, it must pass valid()
+ * @return true when the snapshot was written
+ */
+bool Snapshot::save(const std::string& path, const uint64_t key, const ParseContext& ctx) {
+    const app::arguments::ParserSchema* pSchema = ctx.getSchema();
+    if (pSchema == nullptr || ctx.valid() != ParseContext::MANDATORY_PASSED_ALL) {
+        return false;
+    }
+    const size_t count = pSchema->size();
+    std::vector<Record> records(count, Record{ 0, 0, 0, 0, 0 });
+    std::string strings;
+    for (size_t i = 0; i < count; i++) {
+        Record& rec = records[i];
+        if (!testBit(ctx.present, i)) {
+            continue;
+        }
+        if (!ctx.resolve(i)) {
+            return false;
+        }
+        rec.flags = Record::Present | (testBit(ctx.assigned, i) ? Record::Assigned : 0);
+        const auto& val = ctx.values[i];
+        rec.kind = static_cast<uint8_t>(val.index());
+        std::visit([&rec, &strings](const auto& v) {
+            typedef std::decay_t<decltype(v)> T;
+            if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, app::arguments::BorrowedString>) {
+                rec.kind = 0;
+                rec.length = static_cast<uint32_t>(v.size());
+                rec.payload = strings.size();
+                strings.append(v.data(), v.size());
+                strings.push_back('\0');
+            }
+            else if constexpr (std::is_same_v<T, app::arguments::StringList>) {
+                const std::string_view buf = v.buffer();
+                rec.length = static_cast<uint32_t>(buf.size());
+                rec.payload = strings.size();
+                strings.append(buf.data(), buf.size());
+            }
+            else if constexpr (std::is_class_v<T>) {
+                rec.length = static_cast<uint32_t>(v.size() * sizeof(typename T::value_type));
+                rec.payload = strings.size();
+                strings.append(reinterpret_cast<const char*>(v.data()), rec.length);
+            }
+            else {
+                static_assert(sizeof(T) <= sizeof(rec.payload), "payload is too small");
+                std::memcpy(&rec.payload, &v, sizeof(T));
+            }
+        }, val);
+    }
+    const Header header{ MAGIC, VERSION, key, static_cast<uint32_t>(count), static_cast<uint32_t>(ctx.lastParsed), strings.size() };
+    const std::string tmpPath = path + "." + std::to_string(std::random_device()()) + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(Record)));
+        out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+        if (!out) {
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * maps the snapshot and restores the values into the context
+ * @param path snapshot path
+ * @param key snapshot key from makeKey()
+ * @param schema compiled options the key was computed for
+ * @param ctx receives the values, it is not changed when the snapshot does not match
+ * @return false when there is no snapshot, the key, the version or the schema size do not match or a record is invalid
+ */
+bool Snapshot::load(const std::string& path, const uint64_t key, const app::arguments::ParserSchema& schema, ParseContext& ctx) {
+    if (!file.open(path) || file.size() < sizeof(Header)) {
+        file.close();
+        return false;
+    }
+    Header header{};
+    std::memcpy(&header, file.data(), sizeof(header));
+    const size_t count = schema.size();
+    const size_t recordsSize = count * sizeof(Record);
+    if (header.magic != MAGIC || header.version != VERSION || header.key != key || header.count != count ||
+        file.size() - sizeof(Header) < recordsSize || header.stringsSize != file.size() - sizeof(Header) - recordsSize) {
+        file.close();
+        return false;
+    }
+    const char* const pRecords = file.data() + sizeof(Header);
+    const char* const pStrings = pRecords + recordsSize;
+    for (size_t i = 0; i < count; i++) {
+        Record rec{};
+        std::memcpy(&rec, pRecords + i * sizeof(Record), sizeof(rec));
+        if ((rec.flags & Record::Present) == 0) {
+            continue;
+        }
+        const bool bBlob = rec.kind == 0 || rec.kind >= LIST_KIND;
+        // strings are followed by '\0', the offsets are compared without overflow
+        if (!isKnownKind(rec.kind) || (bBlob && (rec.payload > header.stringsSize ||
+            uint64_t(rec.length) + (rec.kind == 0 ? 1 : 0) > header.stringsSize - rec.payload ||
+            rec.length % elementSize(rec.kind) != 0))) {
+            file.close();
+            return false;
+        }
+    }
+    ctx.reset(schema);
+    ctx.lastParsed = header.lastParsed;
+    for (size_t i = 0; i < count; i++) {
+        Record rec{};
+        std::memcpy(&rec, pRecords + i * sizeof(Record), sizeof(rec));
+        const size_t word = i / app::arguments::MASK_WORD_BITS;
+        const app::arguments::MaskWord bit = app::arguments::MaskWord(1) << (i % app::arguments::MASK_WORD_BITS);
+        ctx.present[word] &= ~bit;
+        if ((rec.flags & Record::Present) == 0) {
+            continue;
+        }
+        auto& val = ctx.values[i];
+        switch (rec.kind) {
+            case 0:
+                if (ctx.stringMode == app::arguments::StringMode::Borrow) {
+                    val = app::arguments::BorrowedString(std::string_view(pStrings + rec.payload, rec.length));
+                }
+                else if (ctx.stringMode == app::arguments::StringMode::Arena) {
+                    val = ctx.arenaString(std::string_view(pStrings + rec.payload, rec.length));
+                }
+                else {
+                    val = std::string(pStrings + rec.payload, rec.length);
+                }
+                break;
+            case 1: {
+                int32_t num = 0;
+                std::memcpy(&num, &rec.payload, sizeof(num));
+                val = num;
+                break;
+            }
+            case 2: {
+                int64_t num = 0;
+                std::memcpy(&num, &rec.payload, sizeof(num));
+                val = num;
+                break;
+            }
+            case 3: {
+                double num = 0;
+                std::memcpy(&num, &rec.payload, sizeof(num));
+                val = num;
+                break;
+            }
+            case LIST_KIND:
+                val = loadNumbers<int32_t>(pStrings + rec.payload, rec.length);
+                break;
+            case LIST_KIND + 1:
+                val = loadNumbers<int64_t>(pStrings + rec.payload, rec.length);
+                break;
+            case LIST_KIND + 2:
+                val = loadNumbers<double>(pStrings + rec.payload, rec.length);
+                break;
+            case LIST_KIND + 3: {
+                app::arguments::StringList items;
+                const char* p = pStrings + rec.payload;
+                const char* const pEnd = p + rec.length;
+                while (p < pEnd) {
+                    const size_t len = ::strnlen(p, static_cast<size_t>(pEnd - p));
+                    items.push_back(std::string_view(p, len));
+                    p += len + 1;
+                }
+                val = std::move(items);
+                break;
+            }
+            case 4:
+            default: { // the kinds were validated above
+                bool flag = false;
+                std::memcpy(&flag, &rec.payload, sizeof(flag));
+                val = flag;
+                break;
+            }
+        }
+        ctx.present[word] |= bit;
+        if ((rec.flags & Record::Assigned) != 0) {
+            ctx.assigned[word] |= bit;
+        }
+    }
+    return true;
+}
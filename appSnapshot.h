@@ -0,0 +1,41 @@
+//
+// Created by shtykov on 10/18/26.
+//
+
+#ifndef APP_SNAPSHOT_H
+#define APP_SNAPSHOT_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "appConfig.h"
+#include "appMappedFile.h"
+
+namespace app::config {
+    /**
+     * binary snapshot of a parsed and validated context. The snapshot is keyed by a hash of the schema,
+     * the parse settings of the context, the command line, the configuration file and the environment variables of the schema, so a later start with the same inputs restores
+     * the values from the memory-mapped snapshot without parsing and falls back to parseArgs() otherwise.
+     * The configuration file is keyed by its path, size and modification time, so it is not read on a warm start:
+     * <pre>
+     * const uint64_t key = Snapshot::makeKey(schema, ctx, argc, argv);
+     * Snapshot snapshot;
+     * if (!snapshot.load(path, key, schema, ctx)) {
+     *     if (ctx.parseArgs(argc, argv, schema) == ParseResult::Parsed) Snapshot::save(path, key, ctx);
+     * }
+     * </pre>
+     * In StringMode::Borrow restored strings point into the mapping, so the snapshot must outlive the values
+     */
+    class Snapshot {
+    public:
+        static constexpr const uint32_t VERSION = 2; // bumped on every format change
+        Snapshot() : file() {};
+        static uint64_t makeKey(const app::arguments::ParserSchema& schema, const ParseContext& ctx, int argc, char** argv,
+            const std::string& configPath = std::string(), char** envp = nullptr);
+        static bool save(const std::string& path, uint64_t key, const ParseContext& ctx);
+        bool load(const std::string& path, uint64_t key, const app::arguments::ParserSchema& schema, ParseContext& ctx);
+    private:
+        MappedFile file;
+    };
+}
+
+#endif //APP_SNAPSHOT_H
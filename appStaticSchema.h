@@ -0,0 +1,139 @@
+//
+// Created by shtykov on 10/18/26.
+//
+
+#ifndef APP_STATIC_SCHEMA_H
+#define APP_STATIC_SCHEMA_H
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "appSchema.h"
+
+namespace app::arguments {
+    /**
+     * literal default value of a compile-time option
+     */
+    class StaticDefault {
+    public:
+        enum class Kind {
+            None = 0,
+            String,
+            Int32,
+            Int64,
+            Float,
+        };
+        Kind kind;
+        std::string_view str;
+        int64_t i;
+        double d;
+        constexpr StaticDefault() : kind(Kind::None), str(), i(0), d(0) {};
+        constexpr StaticDefault(const char* s) : kind(Kind::String), str(s), i(0), d(0) {};
+        constexpr StaticDefault(const int32_t v) : kind(Kind::Int32), str(), i(v), d(0) {};
+        constexpr StaticDefault(const int64_t v) : kind(Kind::Int64), str(), i(v), d(0) {};
+        constexpr StaticDefault(const double v) : kind(Kind::Float), str(), i(0), d(v) {};
+        [[nodiscard]] DefaultValue toDefaultValue() const {
+            switch (kind) {
+                case Kind::String:
+                    return Value(std::string(str));
+                case Kind::Int32:
+                    return Value(static_cast<int32_t>(i));
+                case Kind::Int64:
+                    return Value(i);
+                case Kind::Float:
+                    return Value(d);
+                default:
+                    return DefaultValue();
+            }
+        }
+    };
+
+    /**
+     * compile-time counterpart of Options. All the fields are literals, so the table lives in read-only data
+     */
+    class StaticOption {
+    public:
+        char shortCut;
+        std::string_view name;
+        std::string_view desc;
+        Type type;
+        ValueType valueType;
+        StaticDefault defaultValue;
+        constexpr StaticOption(const char sc, std::string_view name, std::string_view descr, const Type mandatory, const ValueType valType, StaticDefault dv) :
+            shortCut(sc), name(name), desc(descr), type(mandatory), valueType(valType), defaultValue(dv) {};
+        constexpr StaticOption(const char sc, std::string_view name, std::string_view descr, const Type mandatory, const ValueType valType) :
+            shortCut(sc), name(name), desc(descr), type(mandatory), valueType(valType), defaultValue() {};
+        constexpr StaticOption(const char sc, std::string_view name, std::string_view descr) :
+            shortCut(sc), name(name), desc(descr), type(Type::None), valueType(ValueType::None), defaultValue() {};
+        [[nodiscard]] Options toOptions() const {
+            return Options(shortCut, std::string(name), std::string(desc), type, valueType, defaultValue.toDefaultValue());
+        }
+    };
+
+    /**
+     * maps value type to the C++ type returned for it, strings are returned as views of the stored value
+     * and lists as references to the stored list
+     */
+    template <ValueType VT> struct ValueTypeOf { typedef bool type; };
+    template <> struct ValueTypeOf<ValueType::String> { typedef std::string_view type; };
+    template <> struct ValueTypeOf<ValueType::Int32> { typedef int32_t type; };
+    template <> struct ValueTypeOf<ValueType::Int32h> { typedef int32_t type; };
+    template <> struct ValueTypeOf<ValueType::Int64> { typedef int64_t type; };
+    template <> struct ValueTypeOf<ValueType::Int64h> { typedef int64_t type; };
+    template <> struct ValueTypeOf<ValueType::Float> { typedef double type; };
+    template <> struct ValueTypeOf<ValueType::StringList> { typedef const StringList& type; };
+    template <> struct ValueTypeOf<ValueType::Int32List> { typedef const std::vector<int32_t>& type; };
+    template <> struct ValueTypeOf<ValueType::Int32hList> { typedef const std::vector<int32_t>& type; };
+    template <> struct ValueTypeOf<ValueType::Int64List> { typedef const std::vector<int64_t>& type; };
+    template <> struct ValueTypeOf<ValueType::Int64hList> { typedef const std::vector<int64_t>& type; };
+    template <> struct ValueTypeOf<ValueType::FloatList> { typedef const std::vector<double>& type; };
+    template <> struct ValueTypeOf<ValueType::Enum> { typedef int32_t type; };
+
+    /**
+     * compile-time options table. Usage:
+     *   inline constexpr StaticOption opts[] = { ... };
+     *   typedef StaticSchema<opts> Opts;
+     *   cfg.parseArgs(argc, argv, Opts::schema());
+     *   int32_t color = cfg.get<Opts, Opts::index("dark_color")>();
+     * Option names are resolved to indexes by the compiler, an unknown name fails the build
+     * @tparam Table constexpr StaticOption array with static storage duration
+     */
+    template <const auto& Table>
+    class StaticSchema {
+    public:
+        static constexpr const size_t count = std::size(Table);
+        template <size_t I> using type = typename ValueTypeOf<Table[I].valueType>::type;
+        /**
+         * resolves option name into its index
+         * @param name option name
+         * @return option index or ParserSchema::npos when there is no such option
+         */
+        static constexpr size_t index(std::string_view name) {
+            for (size_t i = 0; i < count; i++) {
+                if (Table[i].name == name) {
+                    return i;
+                }
+            }
+            return ParserSchema::npos;
+        }
+        /**
+         * returns the lookup tables for parseArgs(), the tables are built on the first call only
+         * @return compiled options
+         */
+        static const ParserSchema& schema() {
+            static const ParserSchema compiled(options());
+            return compiled;
+        }
+        static std::vector<Options> options() {
+            std::vector<Options> ret;
+            ret.reserve(count);
+            for (const auto& opt : Table) {
+                ret.push_back(opt.toOptions());
+            }
+            return ret;
+        }
+    };
+}
+
+#endif //APP_STATIC_SCHEMA_H
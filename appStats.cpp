@@ -0,0 +1,111 @@
+//
+// Created by shtykov on 10/18/26.
+//
+#include "appStats.h"
+
+#include <atomic>
+#include <cstring>
+#include <sstream>
+using namespace app::config;
+
+namespace {
+    std::atomic<ParseStats::AllocationCounter> allocationCounter(nullptr);
+    thread_local PhaseTimer* pCurrentTimer = nullptr; // the innermost running phase of the thread
+}
+
+/**
+ * zeroes the counters
+ */
+void ParseStats::reset() noexcept {
+    std::memset(phaseNs, 0, sizeof(phaseNs));
+    std::memset(phaseCalls, 0, sizeof(phaseCalls));
+    std::memset(phaseAllocations, 0, sizeof(phaseAllocations));
+    std::memset(conversions, 0, sizeof(conversions));
+    conversionFailures = exceptionsThrown = 0;
+}
+
+/**
+ * exports the counters as a JSON object
+ * @return JSON text
+ */
+std::string ParseStats::toJson() const {
+    static const char* typeNames[VALUE_TYPES] = { "None", "String", "Int32", "Int32h", "Int64", "Int64h", "Float",
+        "StringList", "Int32List", "Int32hList", "Int64List", "Int64hList", "FloatList", "Enum" };
+    std::ostringstream out;
+    out << "{\"enabled\":" << (enabled ? "true" : "false") << ",\"phases\":{";
+    for (size_t i = 0; i < PhaseCount; i++) {
+        out << (i != 0 ? "," : "") << '"' << phaseName(static_cast<Phase>(i)) << "\":{\"ns\":" << phaseNs[i]
+            << ",\"calls\":" << phaseCalls[i] << ",\"allocations\":" << phaseAllocations[i] << '}';
+    }
+    out << "},\"conversions\":{";
+    for (size_t i = 0; i < VALUE_TYPES; i++) {
+        out << (i != 0 ? "," : "") << '"' << typeNames[i] << "\":" << conversions[i];
+    }
+    out << "},\"conversionFailures\":" << conversionFailures << ",\"exceptionsThrown\":" << exceptionsThrown << '}';
+    return out.str();
+}
+
+/**
+ * returns the counters of the calling thread
+ * @return thread statistics
+ */
+ParseStats& ParseStats::current() noexcept {
+    thread_local ParseStats stats;
+    return stats;
+}
+
+/**
+ * installs heap allocations counter, usually backed by a replaced global operator new
+ * @param counter allocations counter or nullptr
+ */
+void ParseStats::setAllocationCounter(const AllocationCounter counter) noexcept {
+    allocationCounter.store(counter, std::memory_order_release);
+}
+
+/**
+ * @return heap allocations made so far or 0 when there is no allocations counter
+ */
+uint64_t ParseStats::allocations() noexcept {
+    const AllocationCounter counter = allocationCounter.load(std::memory_order_acquire);
+    return counter != nullptr ? counter() : 0;
+}
+
+/**
+ * @param phase parse phase
+ * @return phase name used in JSON
+ */
+const char* ParseStats::phaseName(const Phase phase) noexcept {
+    switch (phase) {
+        case SchemaBuild:
+            return "schemaBuild";
+        case Tokenize:
+            return "tokenize";
+        case Conversion:
+            return "conversion";
+        case Validation:
+            return "validation";
+        default:
+            return "unknown";
+    }
+}
+
+PhaseTimer::PhaseTimer(const ParseStats::Phase phase) noexcept :
+    phase(phase), pParent(pCurrentTimer), start(std::chrono::steady_clock::now()),
+    startAllocations(ParseStats::allocations()), childNs(0), childAllocations(0) {
+    pCurrentTimer = this;
+}
+
+PhaseTimer::~PhaseTimer() {
+    const uint64_t elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    const uint64_t allocated = ParseStats::allocations() - startAllocations;
+    ParseStats& stats = ParseStats::current();
+    stats.phaseNs[phase] += elapsed - childNs;
+    stats.phaseAllocations[phase] += allocated - childAllocations;
+    stats.phaseCalls[phase] ++;
+    if (pParent != nullptr) {
+        pParent->childNs += elapsed;
+        pParent->childAllocations += allocated;
+    }
+    pCurrentTimer = pParent;
+}
@@ -0,0 +1,83 @@
+//
+// Created by shtykov on 10/18/26.
+//
+
+#ifndef APP_STATS_H
+#define APP_STATS_H
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "appArguments.h"
+
+namespace app::config {
+    /**
+     * parser instrumentation counters of the calling thread. The counters are collected only when the library
+     * is built with APP_PARSE_STATS defined (cmake -DAPP_PARSE_STATS=ON), otherwise the hooks compile to nothing
+     * and the counters stay zero. Phase times and allocations are exclusive: a conversion inside tokenizing
+     * is not counted twice
+     */
+    class ParseStats {
+    public:
+#if defined(APP_PARSE_STATS)
+        static constexpr const bool enabled = true;
+#else
+        static constexpr const bool enabled = false;
+#endif
+        enum Phase {
+            SchemaBuild = 0, // ParserSchema construction
+            Tokenize, // command line and configuration file scanning
+            Conversion, // Options::acquireValue
+            Validation, // ParseContext::valid
+            PhaseCount
+        };
+        static constexpr const size_t VALUE_TYPES = static_cast<size_t>(app::arguments::ValueType::Enum) + 1;
+        /**
+         * returns the number of heap allocations made so far, the library cannot count them itself
+         */
+        typedef uint64_t (*AllocationCounter)() noexcept;
+        uint64_t phaseNs[PhaseCount];
+        uint64_t phaseCalls[PhaseCount];
+        uint64_t phaseAllocations[PhaseCount];
+        uint64_t conversions[VALUE_TYPES]; // conversions by ValueType
+        uint64_t conversionFailures;
+        uint64_t exceptionsThrown; // by the throwing conversions, the parse path does not throw
+        ParseStats() noexcept { reset(); }
+        void reset() noexcept;
+        [[nodiscard]] std::string toJson() const;
+        static ParseStats& current() noexcept;
+        static void setAllocationCounter(AllocationCounter counter) noexcept;
+        static uint64_t allocations() noexcept;
+        static const char* phaseName(Phase phase) noexcept;
+    };
+
+    /**
+     * measures the enclosing scope as a phase of the current thread statistics
+     */
+    class PhaseTimer {
+    public:
+        explicit PhaseTimer(ParseStats::Phase phase) noexcept;
+        PhaseTimer(const PhaseTimer&) = delete; // no copy constructor
+        PhaseTimer& operator=(const PhaseTimer&) = delete; // no assignment operator
+        ~PhaseTimer();
+    private:
+        ParseStats::Phase phase;
+        PhaseTimer* pParent;
+        std::chrono::steady_clock::time_point start;
+        uint64_t startAllocations;
+        uint64_t childNs; // time of the nested phases
+        uint64_t childAllocations; // allocations of the nested phases
+    };
+}
+
+#if defined(APP_PARSE_STATS)
+#define APP_STATS_CONCAT_(a, b) a##b
+#define APP_STATS_CONCAT(a, b) APP_STATS_CONCAT_(a, b)
+#define APP_STATS_PHASE(phase) app::config::PhaseTimer APP_STATS_CONCAT(appPhaseTimer, __LINE__)(app::config::ParseStats::phase)
+#define APP_STATS_COUNT(counter) (app::config::ParseStats::current().counter ++)
+#else
+#define APP_STATS_PHASE(phase) ((void)0)
+#define APP_STATS_COUNT(counter) ((void)0)
+#endif
+
+#endif //APP_STATS_H
@@ -0,0 +1,139 @@
+//
+// Created by shtykov on 10/18/26.
+//
+#include "appSubcommands.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+using namespace app::config;
+
+/**
+ * indexes the subcommands by name, no schema is built
+ * @param pTable subcommands, the table must outlive the object
+ * @param count subcommands count
+ */
+Subcommands::Subcommands(const Subcommand* pTable, size_t count) : pTable(pTable), count(count), byName(count),
+    schemas(new std::atomic<const app::arguments::ParserSchema*>[count]), buildLock() {
+    for (size_t i = 0; i < count; i++) {
+        byName[i] = i;
+        schemas[i].store(nullptr, std::memory_order_relaxed);
+    }
+    std::sort(byName.begin(), byName.end(), [pTable](size_t a, size_t b) {
+        return std::strcmp(pTable[a].name, pTable[b].name) < 0;
+    });
+}
+
+/**
+ * frees the built schemas, no parsed value may refer to them
+ */
+Subcommands::~Subcommands() {
+    for (size_t i = 0; i < count; i++) {
+        delete schemas[i].load(std::memory_order_acquire);
+    }
+}
+
+/**
+ * resolves subcommand name
+ * @param name subcommand name
+ * @return subcommand index or npos
+ */
+size_t Subcommands::find(std::string_view name) const noexcept {
+    auto it = std::lower_bound(byName.begin(), byName.end(), name, [this](size_t idx, std::string_view key) {
+        return std::string_view(pTable[idx].name) < key;
+    });
+    return it != byName.end() && pTable[*it].name == name ? *it : npos;
+}
+
+/**
+ * returns the subcommand schema, the options table and the schema are built on the first call.
+ * Concurrent calls are safe
+ * @param idx subcommand index
+ * @return subcommand schema
+ */
+const app::arguments::ParserSchema& Subcommands::schema(size_t idx) const {
+    const app::arguments::ParserSchema* pSchema = schemas[idx].load(std::memory_order_acquire);
+    if (pSchema == nullptr) {
+        std::lock_guard<std::mutex> lock(buildLock);
+        pSchema = schemas[idx].load(std::memory_order_relaxed);
+        if (pSchema == nullptr) {
+            pSchema = new app::arguments::ParserSchema(pTable[idx].options());
+            schemas[idx].store(pSchema, std::memory_order_release);
+        }
+    }
+    return *pSchema;
+}
+
+/**
+ * parses the global options up to the subcommand word and the rest of the arguments with the subcommand schema
+ * @param argc argument count
+ * @param argv argument values
+ * @param globalSchema global options schema
+ * @param global receives the global options
+ * @param command receives the subcommand options, its argv[0] is the subcommand word
+ * @param selected receives the subcommand index or npos when the command line has no subcommand
+ * @return parse result, ParseResult::Unknown for an unknown subcommand with badArgumentIndex of global.
+ * The subcommand argument indices of command are converted into argv indices
+ */
+ParseResult Subcommands::parse(int argc, char** argv, const app::arguments::ParserSchema& globalSchema, ParseContext& global,
+    ParseContext& command, size_t& selected) const {
+    selected = npos;
+    const bool bStop = global.getStopAtOperand();
+    global.setStopAtOperand(true);
+    const ParseResult res = global.parseArgs(argc, argv, globalSchema);
+    global.setStopAtOperand(bStop);
+    if (res != ParseResult::Parsed || global.operandIndex == 0) {
+        return res;
+    }
+    const size_t word = global.operandIndex;
+    const size_t idx = find(argv[word]);
+    if (idx == npos) {
+        global.badArgumentIndex = word;
+        return ParseResult::Unknown;
+    }
+    selected = idx;
+    const ParseResult cmdRes = command.parseArgs(argc - static_cast<int>(word), argv + word, schema(idx));
+    if (cmdRes != ParseResult::Parsed) {
+        command.badArgumentIndex += word;
+    }
+    if (command.lastParsed != 0) {
+        command.lastParsed += word;
+    }
+    return cmdRes;
+}
+
+/**
+ * prints usage help message with the global options and the subcommands list, no subcommand schema is built
+ * @param globalMap global options
+ * @param progName - program name to be displayed
+ * @param out - an output stream receives the usage message
+ * @return the output stream resulting state
+ */
+std::ostream& Subcommands::printHelp(const std::vector<app::arguments::Options>& globalMap, const std::string& progName, std::ostream& out) const {
+    out << std::endl << "Usage: " << std::endl << std::filesystem::path(progName).filename().string()
+        << " [options] <command> [command options]" << std::endl;
+    ParseContext::printOptions(globalMap, out);
+    out << "Commands:" << std::endl;
+    size_t width = 0;
+    for (size_t i = 0; i < count; i++) {
+        width = std::max(width, std::strlen(pTable[i].name));
+    }
+    for (const size_t idx : byName) {
+        const std::string_view name = pTable[idx].name;
+        out << '\t' << name << std::string(width - name.size() + 2, ' ') << pTable[idx].desc << std::endl;
+    }
+    return out;
+}
+
+/**
+ * prints usage help message of one subcommand, its schema is built
+ * @param idx subcommand index
+ * @param progName - program name to be displayed
+ * @param out - an output stream receives the usage message
+ * @return the output stream resulting state
+ */
+std::ostream& Subcommands::printHelp(size_t idx, const std::string& progName, std::ostream& out) const {
+    out << std::endl << "Usage: " << std::endl << std::filesystem::path(progName).filename().string()
+        << ' ' << pTable[idx].name << " [options]" << std::endl << pTable[idx].desc << std::endl;
+    return ParseContext::printOptions(schema(idx).options(), out);
+}
@@ -0,0 +1,74 @@
+//
+// Created by shtykov on 10/18/26.
+//
+
+#ifndef APP_SUBCOMMANDS_H
+#define APP_SUBCOMMANDS_H
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "appConfig.h"
+
+namespace app::config {
+    /**
+     * subcommand description, usually an element of a static table
+     */
+    class Subcommand {
+    public:
+        const char* name;
+        const char* desc;
+        std::vector<app::arguments::Options> (*options)(); // builds the subcommand options, called when it is selected
+    };
+
+    /**
+     * git-style subcommands: the global options are parsed up to the subcommand word and the rest of the command
+     * line is parsed with the subcommand schema, the subcommand word being its argv[0]. A subcommand options table
+     * and schema are built only when the subcommand is selected, so start-up costs nothing per subcommand. Usage:
+     * <pre>
+     * static std::vector<Options> buildOptions() { return { Options('a', "all", "all files") }; }
+     * static const Subcommand commands[] = { { "build", "builds the project", buildOptions }, ... };
+     * static const Subcommands subcommands(commands);
+     * size_t idx;
+     * ParseResult res = subcommands.parse(argc, argv, globalSchema, globalCtx, commandCtx, idx);
+     * </pre>
+     */
+    class Subcommands {
+    public:
+        static constexpr const size_t npos = static_cast<size_t>(-1);
+        Subcommands(const Subcommand* pTable, size_t count);
+        /**
+         * @param table subcommands, the table must outlive the object
+         */
+        template <size_t N>
+        explicit Subcommands(const Subcommand (&table)[N]) : Subcommands(table, N) {}
+        Subcommands(const Subcommands&) = delete; // no copy constructor
+        Subcommands& operator=(const Subcommands&) = delete; // no assignment operator
+        ~Subcommands();
+        [[nodiscard]] size_t size() const noexcept { return count; }
+        [[nodiscard]] const Subcommand& operator[](size_t idx) const noexcept { return pTable[idx]; }
+        [[nodiscard]] size_t find(std::string_view name) const noexcept;
+        [[nodiscard]] const app::arguments::ParserSchema& schema(size_t idx) const;
+        /**
+         * @param idx subcommand index
+         * @return true when the subcommand schema was built
+         */
+        [[nodiscard]] bool isBuilt(size_t idx) const noexcept { return schemas[idx].load(std::memory_order_acquire) != nullptr; }
+        ParseResult parse(int argc, char** argv, const app::arguments::ParserSchema& globalSchema, ParseContext& global,
+            ParseContext& command, size_t& selected) const;
+        std::ostream& printHelp(const std::vector<app::arguments::Options>& globalMap, const std::string& progName, std::ostream& out) const;
+        std::ostream& printHelp(size_t idx, const std::string& progName, std::ostream& out) const;
+    private:
+        const Subcommand* pTable;
+        size_t count;
+        std::vector<size_t> byName; // subcommand indices sorted by name
+        std::unique_ptr<std::atomic<const app::arguments::ParserSchema*>[]> schemas; // built schemas or nullptr
+        mutable std::mutex buildLock; // serializes schema builds
+    };
+}
+
+#endif //APP_SUBCOMMANDS_H
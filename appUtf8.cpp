@@ -0,0 +1,340 @@
+//
+// Created by shtykov on 10/18/26.
+//
+#include "appUtf8.h"
+
+#include <cwchar>
+#include <type_traits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define APP_HAVE_SSE2 1
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define APP_HAVE_UTF8_SIMD 1 // SSSE3 and AVX2 validators selected at run time
+#endif
+using namespace app::arguments;
+
+static inline bool isContinuation(const unsigned char c) noexcept {
+    return (c & 0xc0) == 0x80;
+}
+
+/**
+ * validates one multi-byte sequence
+ * @param p the lead byte
+ * @param pEnd string end
+ * @return the sequence length or 0 when the sequence is truncated, overlong, a surrogate or above U+10FFFF
+ */
+static size_t validSequence(const unsigned char* p, const unsigned char* pEnd) noexcept {
+    const unsigned char c = *p;
+    const size_t left = static_cast<size_t>(pEnd - p);
+    if (c < 0xc2) {
+        return 0; // a continuation byte or an overlong 2-byte sequence
+    }
+    if (c < 0xe0) {
+        return left >= 2 && isContinuation(p[1]) ? 2 : 0;
+    }
+    if (c < 0xf0) {
+        // E0 must not be overlong, ED must not encode surrogates
+        const unsigned char lo = c == 0xe0 ? 0xa0 : 0x80;
+        const unsigned char hi = c == 0xed ? 0x9f : 0xbf;
+        return left >= 3 && p[1] >= lo && p[1] <= hi && isContinuation(p[2]) ? 3 : 0;
+    }
+    if (c < 0xf5) {
+        // F0 must not be overlong, F4 must not exceed U+10FFFF
+        const unsigned char lo = c == 0xf0 ? 0x90 : 0x80;
+        const unsigned char hi = c == 0xf4 ? 0x8f : 0xbf;
+        return left >= 4 && p[1] >= lo && p[1] <= hi && isContinuation(p[2]) && isContinuation(p[3]) ? 4 : 0;
+    }
+    return 0;
+}
+
+/**
+ * returns where the scalar validation resumes after a validated block: the lead byte of a sequence which may
+ * continue past the block, the block end otherwise
+ * @param pBegin string start
+ * @param p block end
+ * @return sequence boundary, the bytes before it are valid
+ */
+static const unsigned char* sequenceStart(const unsigned char* const pBegin, const unsigned char* const p) noexcept {
+    for (size_t k = 1; k <= 3 && p - k >= pBegin; k++) {
+        if (p[-k] >= 0xc0) {
+            return p - k;
+        }
+        if (p[-k] < 0x80) {
+            break;
+        }
+    }
+    return p;
+}
+
+#if defined(APP_HAVE_UTF8_SIMD)
+/*
+ * block validation with nibble lookup tables (Keiser, Lemire "Validating UTF-8 in less than one instruction per byte").
+ * Every byte is classified by the high nibble of the previous byte, its low nibble and the high nibble of the byte itself,
+ * a bit set in all three lookups is an error of the byte pair. The third and fourth bytes of the longer sequences
+ * are checked against the lead bytes two and three positions back
+ */
+namespace {
+    const uint8_t TOO_SHORT = 1 << 0; // a lead or ASCII byte after a lead
+    const uint8_t TOO_LONG = 1 << 1; // a continuation after ASCII
+    const uint8_t OVERLONG_3 = 1 << 2; // E0 80..9F
+    const uint8_t TOO_LARGE = 1 << 3; // F4 90..BF or F5..FF
+    const uint8_t SURROGATE = 1 << 4; // ED A0..BF
+    const uint8_t OVERLONG_2 = 1 << 5; // C0, C1
+    const uint8_t TOO_LARGE_1000 = 1 << 6; // F5..FF 80..8F
+    const uint8_t OVERLONG_4 = 1 << 6; // F0 80..8F
+    const uint8_t TWO_CONTS = 1 << 7; // a continuation after a continuation, valid in 3 and 4-byte sequences
+    const uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+    alignas(16) const uint8_t BYTE_1_HIGH[16] = {
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+        TOO_SHORT | OVERLONG_2, TOO_SHORT, TOO_SHORT | OVERLONG_3 | SURROGATE, TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4 };
+    alignas(16) const uint8_t BYTE_1_LOW[16] = {
+        CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4, CARRY | OVERLONG_2, CARRY, CARRY,
+        CARRY | TOO_LARGE, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000 };
+    alignas(16) const uint8_t BYTE_2_HIGH[16] = {
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE, TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT };
+    // the greatest bytes which complete a sequence at the last three positions of a block
+    alignas(16) const uint8_t INCOMPLETE_MAX[16] = { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        0xf0 - 1, 0xe0 - 1, 0xc0 - 1 };
+}
+
+/**
+ * validates 16-byte blocks with SSSE3
+ * @param pBegin string start
+ * @param pEnd string end
+ * @return sequence boundary where the scalar validation resumes: the lead of the first invalid block or the tail
+ */
+__attribute__((target("ssse3")))
+static const unsigned char* validateBlocksSsse3(const unsigned char* const pBegin, const unsigned char* const pEnd) noexcept {
+    const __m128i byte1High = _mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_1_HIGH));
+    const __m128i byte1Low = _mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_1_LOW));
+    const __m128i byte2High = _mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_2_HIGH));
+    const __m128i incompleteMax = _mm_load_si128(reinterpret_cast<const __m128i*>(INCOMPLETE_MAX));
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    __m128i prev = _mm_setzero_si128();
+    bool bIncomplete = false; // the previous block ends inside a sequence
+    const unsigned char* p = pBegin;
+    for (; pEnd - p >= 16; p += 16) {
+        const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        if (_mm_movemask_epi8(input) == 0) {
+            if (bIncomplete) {
+                break; // ASCII block after an incomplete sequence
+            }
+            prev = input;
+            continue;
+        }
+        const __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+        const __m128i special = _mm_and_si128(_mm_and_si128(
+            _mm_shuffle_epi8(byte1High, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+            _mm_shuffle_epi8(byte1Low, _mm_and_si128(prev1, nibble))),
+            _mm_shuffle_epi8(byte2High, _mm_and_si128(_mm_srli_epi16(input, 4), nibble)));
+        const __m128i third = _mm_subs_epu8(_mm_alignr_epi8(input, prev, 14), _mm_set1_epi8(static_cast<char>(0xe0 - 0x80)));
+        const __m128i fourth = _mm_subs_epu8(_mm_alignr_epi8(input, prev, 13), _mm_set1_epi8(static_cast<char>(0xf0 - 0x80)));
+        const __m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+        const __m128i error = _mm_xor_si128(must23, special);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) != 0xffff) {
+            break;
+        }
+        bIncomplete = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(input, incompleteMax), _mm_setzero_si128())) != 0xffff;
+        prev = input;
+    }
+    return sequenceStart(pBegin, p);
+}
+
+/**
+ * validates 32-byte blocks with AVX2, see validateBlocksSsse3()
+ * @param pBegin string start
+ * @param pEnd string end
+ * @return sequence boundary where the scalar validation resumes: the lead of the first invalid block or the tail
+ */
+__attribute__((target("avx2")))
+static const unsigned char* validateBlocksAvx2(const unsigned char* const pBegin, const unsigned char* const pEnd) noexcept {
+    const __m256i byte1High = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_1_HIGH)));
+    const __m256i byte1Low = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_1_LOW)));
+    const __m256i byte2High = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_2_HIGH)));
+    const __m256i incompleteMax = _mm256_set_m128i(_mm_load_si128(reinterpret_cast<const __m128i*>(INCOMPLETE_MAX)), _mm_set1_epi8(-1));
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    __m256i prev = _mm256_setzero_si256();
+    bool bIncomplete = false;
+    const unsigned char* p = pBegin;
+    for (; pEnd - p >= 32; p += 32) {
+        const __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        if (_mm256_movemask_epi8(input) == 0) {
+            if (bIncomplete) {
+                break;
+            }
+            prev = input;
+            continue;
+        }
+        // the previous bytes: the upper lane of prev followed by the lower lane of input
+        const __m256i shifted = _mm256_permute2x128_si256(prev, input, 0x21);
+        const __m256i prev1 = _mm256_alignr_epi8(input, shifted, 15);
+        const __m256i special = _mm256_and_si256(_mm256_and_si256(
+            _mm256_shuffle_epi8(byte1High, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+            _mm256_shuffle_epi8(byte1Low, _mm256_and_si256(prev1, nibble))),
+            _mm256_shuffle_epi8(byte2High, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble)));
+        const __m256i third = _mm256_subs_epu8(_mm256_alignr_epi8(input, shifted, 14), _mm256_set1_epi8(static_cast<char>(0xe0 - 0x80)));
+        const __m256i fourth = _mm256_subs_epu8(_mm256_alignr_epi8(input, shifted, 13), _mm256_set1_epi8(static_cast<char>(0xf0 - 0x80)));
+        const __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+        const __m256i error = _mm256_xor_si256(must23, special);
+        if (!_mm256_testz_si256(error, error)) {
+            break;
+        }
+        const __m256i incomplete = _mm256_subs_epu8(input, incompleteMax);
+        bIncomplete = !_mm256_testz_si256(incomplete, incomplete);
+        prev = input;
+    }
+    return sequenceStart(pBegin, p);
+}
+
+typedef const unsigned char* (*BlockValidator)(const unsigned char*, const unsigned char*) noexcept;
+
+/**
+ * selects the widest block validator the CPU supports
+ * @return block validator or nullptr for the scalar validation only
+ */
+static BlockValidator selectBlockValidator() noexcept {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return validateBlocksAvx2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        return validateBlocksSsse3;
+    }
+    return nullptr;
+}
+#endif
+
+/**
+ * validates UTF-8 string. Strings of 64 bytes and more are validated in blocks with AVX2 or SSSE3 lookup tables
+ * when the CPU supports them, the scalar validation checks the tail and locates the error of an invalid block.
+ * It skips ASCII runs 16 bytes at a time when SSE2 is available and checks multi-byte runs sequence by sequence
+ * @param str string to validate
+ * @return byte offset of the first invalid sequence or UTF8_VALID
+ */
+size_t app::arguments::validateUtf8(std::string_view str) noexcept {
+    const auto* const pBegin = reinterpret_cast<const unsigned char*>(str.data());
+    const auto* const pEnd = pBegin + str.size();
+    const unsigned char* p = pBegin;
+#if defined(APP_HAVE_UTF8_SIMD)
+    static const BlockValidator pBlocks = selectBlockValidator();
+    if (pBlocks != nullptr && str.size() >= 64) {
+        p = pBlocks(pBegin, pEnd);
+    }
+#endif
+    while (p < pEnd) {
+#if defined(APP_HAVE_SSE2)
+        for (; pEnd - p >= 16; p += 16) {
+            const int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+            if (mask != 0) {
+                p += __builtin_ctz(static_cast<unsigned>(mask));
+                break;
+            }
+        }
+#endif
+        while (p < pEnd && *p < 0x80) {
+            p ++;
+        }
+        while (p < pEnd && *p >= 0x80) {
+            const size_t len = validSequence(p, pEnd);
+            if (len == 0) {
+                return static_cast<size_t>(p - pBegin);
+            }
+            p += len;
+        }
+    }
+    return UTF8_VALID;
+}
+
+/**
+ * writes code point encoded in UTF-8
+ * @param pOut output position, receives the position after the sequence
+ * @param cp valid code point
+ */
+static void writeUtf8(char*& pOut, const char32_t cp) noexcept {
+    if (cp < 0x800) {
+        *pOut++ = static_cast<char>(0xc0 | (cp >> 6));
+    }
+    else if (cp < 0x10000) {
+        *pOut++ = static_cast<char>(0xe0 | (cp >> 12));
+        *pOut++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+    }
+    else {
+        *pOut++ = static_cast<char>(0xf0 | (cp >> 18));
+        *pOut++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+        *pOut++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+    }
+    *pOut++ = static_cast<char>(0x80 | (cp & 0x3f));
+}
+
+/**
+ * converts wide character arguments into UTF-8 in a buffer sized for the longest encoding, ASCII characters
+ * are copied as they are
+ * @param argc argument count
+ * @param argv wide character argument values
+ * @return conversion result, badArgumentIndex and badArgumentOffset locate the bad character,
+ * badArgumentIndex the nullptr argument
+ */
+app::config::WideArguments::Result app::config::WideArguments::convert(int argc, const wchar_t* const* argv) {
+    typedef std::make_unsigned_t<wchar_t> WideUnit;
+    buffer.clear();
+    args.clear();
+    badArgumentIndex = badArgumentOffset = 0;
+    size_t total = 0;
+    for (int i = 0; i < argc; i++) {
+        if (argv[i] == nullptr) {
+            badArgumentIndex = static_cast<size_t>(i);
+            return Result::NullArgument;
+        }
+        total += std::wcslen(argv[i]) + 1;
+    }
+    // a UTF-16 unit takes up to 3 bytes (a surrogate pair 4 bytes), a UTF-32 unit up to 4 bytes
+    buffer.resize(total * (sizeof(wchar_t) == 2 ? 3 : 4));
+    char* const pBegin = buffer.data();
+    char* pOut = pBegin;
+    std::vector<size_t> offsets;
+    offsets.reserve(static_cast<size_t>(argc));
+    for (int i = 0; i < argc; i++) {
+        const wchar_t* pArg = argv[i];
+        offsets.push_back(static_cast<size_t>(pOut - pBegin));
+        for (size_t k = 0; pArg[k] != 0; k++) {
+            char32_t cp = static_cast<WideUnit>(pArg[k]);
+            if (cp < 0x80) {
+                *pOut++ = static_cast<char>(cp);
+                continue;
+            }
+            const size_t offset = k;
+            if constexpr (sizeof(wchar_t) == 2) {
+                const char32_t next = static_cast<WideUnit>(pArg[k + 1]);
+                if (cp >= 0xd800 && cp <= 0xdbff && next >= 0xdc00 && next <= 0xdfff) {
+                    cp = 0x10000 + ((cp - 0xd800) << 10) + (next - 0xdc00);
+                    k ++;
+                }
+            }
+            if ((cp >= 0xd800 && cp <= 0xdfff) || cp > 0x10ffff) {
+                badArgumentIndex = static_cast<size_t>(i);
+                badArgumentOffset = offset;
+                buffer.clear();
+                return Result::BadCharacter;
+            }
+            writeUtf8(pOut, cp);
+        }
+        *pOut++ = '\0';
+    }
+    buffer.resize(static_cast<size_t>(pOut - pBegin));
+    args.reserve(offsets.size() + 1);
+    for (const size_t offset : offsets) {
+        args.push_back(buffer.data() + offset);
+    }
+    args.push_back(nullptr);
+    return Result::Converted;
+}
@@ -0,0 +1,52 @@
+//
+// Created by shtykov on 10/18/26.
+//
+
+#ifndef APP_UTF8_H
+#define APP_UTF8_H
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace app::arguments {
+    static constexpr const size_t UTF8_VALID = static_cast<size_t>(-1);
+    /**
+     * returns the UTF-8 sequence length by its lead byte
+     * @param lead the first byte of the sequence
+     * @return 2 to 4 for multi-byte lead bytes, 1 otherwise
+     */
+    constexpr size_t utf8SequenceLength(const char lead) noexcept {
+        const auto c = static_cast<unsigned char>(lead);
+        return c >= 0xf0 ? 4 : c >= 0xe0 ? 3 : c >= 0xc0 ? 2 : 1;
+    }
+    size_t validateUtf8(std::string_view str) noexcept;
+}
+
+namespace app::config {
+    /**
+     * wide character arguments of wmain() converted into UTF-8 argv. wchar_t strings are UTF-16 where wchar_t has
+     * 16 bits (Windows) and UTF-32 elsewhere. The converter must outlive the parsed values in StringMode::Borrow
+     */
+    class WideArguments {
+    public:
+        enum class Result {
+            Converted = 0,
+            BadCharacter, // unpaired surrogate or not a Unicode code point
+            NullArgument, // argv element is nullptr
+        };
+        WideArguments() : badArgumentIndex(0), badArgumentOffset(0), buffer(), args() {};
+        WideArguments(const WideArguments&) = delete; // no copy constructor
+        WideArguments& operator=(const WideArguments&) = delete; // no assignment operator
+        Result convert(int argc, const wchar_t* const* argv);
+        [[nodiscard]] int argc() const noexcept { return args.empty() ? 0 : static_cast<int>(args.size() - 1); }
+        [[nodiscard]] char** argv() noexcept { return args.data(); }
+        size_t badArgumentIndex; // the argument which conversion failed
+        size_t badArgumentOffset; // the wchar_t offset in the failed argument
+    private:
+        std::string buffer; // '\0' terminated converted arguments
+        std::vector<char*> args; // converted arguments followed by nullptr
+    };
+}
+
+#endif //APP_UTF8_H
@@ -0,0 +1,1508 @@
+// getOptPlusPlus_bench.cpp : measures parser throughput on synthetic option tables.
+//
+
+#include "appBatch.h"
+#include "appCommandString.h"
+#include "appConfig.h"
+#include "appLiveConfig.h"
+#include "appNumeric.h"
+#include "appResponseFile.h"
+#include "appSnapshot.h"
+#include "appStats.h"
+#include "appSubcommands.h"
+#include "appUtf8.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <functional>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+#if defined(__GLIBC__)
+#include <getopt.h>
+#endif
+using namespace std;
+
+static std::atomic<size_t> allocations(0); // global operator new calls
+
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size != 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * reports the private memory of the process, file pages copied on write are counted, clean file pages are not
+ * @return anonymous resident memory in kilobytes or 0 when unknown
+ */
+static long privateKb()
+{
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 8, "RssAnon:") == 0) {
+            return std::strtol(line.c_str() + 8, nullptr, 10);
+        }
+    }
+#endif
+    return 0;
+}
+
+/**
+ * reports the process peak resident set size
+ * @return peak RSS in kilobytes or 0 when unknown
+ */
+static long peakRssKb()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return 0;
+}
+
+/**
+ * generates synthetic options vector
+ * @param count options count
+ * @return options vector with mixed value types
+ */
+static std::vector<app::arguments::Options> makeOptions(size_t count)
+{
+    static const char shortCuts[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    std::vector<app::arguments::Options> ret;
+    ret.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        const char sc = i < sizeof(shortCuts) - 1 ? shortCuts[i] : ' ';
+        std::string name = "option_" + std::to_string(i);
+        switch (i % 4) {
+        case 0:
+            ret.emplace_back(sc, name, "a flag");
+            break;
+        case 1:
+            ret.emplace_back(sc, name, "an integer", app::arguments::Type::Optional, app::arguments::ValueType::Int32);
+            break;
+        case 2:
+            ret.emplace_back(sc, name, "a string", app::arguments::Type::Optional, app::arguments::ValueType::String);
+            break;
+        default:
+            ret.emplace_back(sc, name, "a float", app::arguments::Type::Optional, app::arguments::ValueType::Float);
+            break;
+        }
+    }
+    return ret;
+}
+
+/**
+ * generates synthetic command line for the options vector. It mixes short option clusters,
+ * short and long options with integer, string and float values
+ * @param optMap options vector
+ * @param storage receives argument strings
+ * @param argCount arguments to generate, not counting the program name
+ * @return argument pointers, the first one is the program name
+ */
+static std::vector<char*> makeArgv(const std::vector<app::arguments::Options>& optMap, std::vector<std::string>& storage, size_t argCount = 64)
+{
+    storage.clear();
+    storage.reserve(argCount + 2);
+    storage.emplace_back("bench");
+    // flags are every 4th option, the first three of them have shortcuts when there are at least 9 options
+    const bool bClusters = optMap.size() > 8;
+    for (size_t step = 0; storage.size() <= argCount; step++) {
+        if (bClusters && step % 5 == 4) {
+            storage.push_back(std::string("-") + optMap[0].shortCut + optMap[4].shortCut + optMap[8].shortCut);
+            continue;
+        }
+        const size_t i = (step * 7919) % optMap.size();
+        const auto& opt = optMap[i];
+        if (step % 2 == 0 && opt.shortCut != ' ') {
+            storage.push_back(std::string("-") + opt.shortCut);
+        }
+        else {
+            storage.push_back("--" + opt.name);
+        }
+        switch (opt.valueType) {
+        case app::arguments::ValueType::Int32:
+            storage.push_back(std::to_string(step * 7 % 100000));
+            break;
+        case app::arguments::ValueType::String:
+            storage.push_back("/tmp/path/" + std::to_string(step % 1000));
+            break;
+        case app::arguments::ValueType::Float:
+            storage.push_back("0.75");
+            break;
+        default:
+            break;
+        }
+    }
+    std::vector<char*> ret;
+    ret.reserve(storage.size());
+    for (auto& s : storage) {
+        ret.push_back(s.data());
+    }
+    return ret;
+}
+
+template <typename F>
+static double nsPerCall(size_t iterations, F&& f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        f();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(iterations);
+}
+
+/**
+ * compares per call cost of the options vector overload (lookup tables rebuilt on each call)
+ * and the ParserSchema overload (lookup tables built once)
+ */
+static void benchSchema()
+{
+    app::config::Config& cfg = app::config::Config::getInstance();
+    std::cout << "parseArgs per call cost" << std::endl;
+    std::cout << std::setw(10) << "options" << std::setw(16) << "vector, ns" << std::setw(16) << "schema, ns" << std::endl;
+    for (size_t count : {10, 100, 1000}) {
+        auto optMap = makeOptions(count);
+        std::vector<std::string> storage;
+        auto argv = makeArgv(optMap, storage);
+        const int argc = static_cast<int>(argv.size());
+        const app::arguments::ParserSchema schema(optMap);
+        const size_t iterations = 200000 / count + 100;
+        double before = nsPerCall(iterations, [&]() { cfg.parseArgs(argc, argv.data(), optMap); });
+        double after = nsPerCall(iterations, [&]() { cfg.parseArgs(argc, argv.data(), schema); });
+        std::cout << std::setw(10) << count << std::setw(16) << std::fixed << std::setprecision(0) << before
+            << std::setw(16) << after << std::endl;
+    }
+}
+
+/**
+ * the former istringstream based conversion, kept as the baseline
+ */
+template <typename T>
+static T legacyInteger(const char* optArg, const int base)
+{
+    if (base == 16 && optArg[0] == '0' && (optArg[1] == 'x' || optArg[1] == 'X')) {
+        optArg += 2;
+    }
+    std::istringstream iss(optArg);
+    iss.exceptions(std::istream::failbit | std::istream::badbit);
+    if (base == 16) {
+        iss >> std::hex;
+    }
+    T ret;
+    iss >> ret;
+    return ret;
+}
+
+/**
+ * compares istringstream/strtod conversion with the from_chars based one
+ */
+static void benchNumeric()
+{
+    const size_t count = 4000000;
+    std::vector<std::string> storage;
+    storage.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        storage.push_back(std::to_string(i * 2654435761u % 2000000000));
+    }
+    std::vector<std::string> hexStorage;
+    hexStorage.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        std::ostringstream oss;
+        oss << "0x" << std::hex << (i * 40503u);
+        hexStorage.push_back(oss.str());
+    }
+    std::vector<std::string> floatStorage;
+    floatStorage.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        floatStorage.push_back(std::to_string(static_cast<double>(i) / 7.0));
+    }
+    const app::arguments::Options optInt('i', "int", "", app::arguments::Type::Mandatory, app::arguments::ValueType::Int32);
+    const app::arguments::Options optHex('x', "hex", "", app::arguments::Type::Mandatory, app::arguments::ValueType::Int64h);
+    const app::arguments::Options optFloat('f', "float", "", app::arguments::Type::Mandatory, app::arguments::ValueType::Float);
+    int64_t sum = 0;
+    double dSum = 0;
+    std::cout << "numeric conversion of " << count << " arguments, ns per argument" << std::endl;
+    std::cout << std::setw(10) << "type" << std::setw(16) << "legacy" << std::setw(16) << "from_chars" << std::endl;
+    size_t n = 0;
+    double before = nsPerCall(count, [&]() { sum += legacyInteger<int32_t>(storage[n++].c_str(), 10); });
+    n = 0;
+    double after = nsPerCall(count, [&]() { sum += std::get<int32_t>(optInt.acquireValue(storage[n++].c_str())); });
+    std::cout << std::setw(10) << "Int32" << std::setw(16) << std::fixed << std::setprecision(1) << before << std::setw(16) << after << std::endl;
+    n = 0;
+    before = nsPerCall(count, [&]() { sum += legacyInteger<int64_t>(hexStorage[n++].c_str(), 16); });
+    n = 0;
+    after = nsPerCall(count, [&]() { sum += std::get<int64_t>(optHex.acquireValue(hexStorage[n++].c_str())); });
+    std::cout << std::setw(10) << "Int64h" << std::setw(16) << before << std::setw(16) << after << std::endl;
+    n = 0;
+    before = nsPerCall(count, [&]() { dSum += strtod(floatStorage[n++].c_str(), nullptr); });
+    n = 0;
+    after = nsPerCall(count, [&]() { dSum += std::get<double>(optFloat.acquireValue(floatStorage[n++].c_str())); });
+    std::cout << std::setw(10) << "Float" << std::setw(16) << before << std::setw(16) << after << std::endl;
+    size_t failures = 0;
+    n = 0;
+    before = nsPerCall(count, [&]() {
+        try {
+            sum += legacyInteger<int32_t>(floatStorage[n++].c_str(), 10);
+        } catch (const std::exception&) {
+            failures++;
+        }
+    });
+    n = 0;
+    after = nsPerCall(count, [&]() {
+        int32_t val = 0;
+        if (app::arguments::toInteger(floatStorage[n++], 10, val) != app::arguments::ConvResult::Ok) {
+            failures++;
+        }
+        sum += val;
+    });
+    std::cout << std::setw(10) << "bad Int32" << std::setw(16) << before << std::setw(16) << after << std::endl;
+    std::cout << "checksum " << sum << " " << dSum << " " << failures << std::endl;
+}
+
+/**
+ * parses the same command lines with independent contexts on several threads
+ */
+static void benchThreads()
+{
+    const auto optMap = makeOptions(100);
+    const app::arguments::ParserSchema schema(optMap);
+    std::vector<std::string> storage;
+    auto argv = makeArgv(optMap, storage);
+    const int argc = static_cast<int>(argv.size());
+    const size_t perThread = 20000;
+    const unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "concurrent parsing with ParseContext, " << perThread << " command lines per thread" << std::endl;
+    std::cout << std::setw(10) << "threads" << std::setw(20) << "lines per second" << std::setw(10) << "scaling" << std::endl;
+    double single = 0;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; t++) {
+            pool.emplace_back([&]() {
+                app::config::ParseContext ctx;
+                for (size_t i = 0; i < perThread; i++) {
+                    ctx.parseArgs(argc, argv.data(), schema);
+                }
+            });
+        }
+        for (auto& th : pool) {
+            th.join();
+        }
+        auto stop = std::chrono::steady_clock::now();
+        const double rate = static_cast<double>(perThread * threads) / std::chrono::duration<double>(stop - start).count();
+        if (threads == 1) {
+            single = rate;
+        }
+        std::cout << std::setw(10) << threads << std::setw(20) << std::fixed << std::setprecision(0) << rate
+            << std::setw(10) << std::setprecision(2) << rate / single << std::endl;
+        if (threads * 2 > maxThreads && threads != maxThreads) {
+            threads = maxThreads / 2;
+        }
+    }
+}
+
+#if defined(__GLIBC__)
+/**
+ * getopt_long tables built from the options vector, option values are converted the same way
+ * the parser does, so both sides perform the same amount of work
+ */
+class GetOptLong {
+public:
+    explicit GetOptLong(const std::vector<app::arguments::Options>& optMap) : optMap(optMap), longOpts(), shortOpts(":") {
+        for (size_t i = 0; i < optMap.size(); i++) {
+            const auto& opt = optMap[i];
+            const int hasArg = opt.type == app::arguments::Type::None ? no_argument : required_argument;
+            longOpts.push_back({ opt.name.c_str(), hasArg, nullptr, static_cast<int>(256 + i) });
+            if (opt.shortCut != ' ') {
+                shortOpts += opt.shortCut;
+                if (hasArg == required_argument) {
+                    shortOpts += ':';
+                }
+            }
+        }
+        longOpts.push_back({ nullptr, 0, nullptr, 0 });
+    }
+    size_t parse(int argc, char** argv) {
+        size_t ret = 0;
+        int c;
+        optind = 0; // full glibc reinitialization
+        while ((c = getopt_long(argc, argv, shortOpts.c_str(), longOpts.data(), nullptr)) != -1) {
+            size_t idx = c >= 256 ? static_cast<size_t>(c - 256) : shortIndex(static_cast<char>(c));
+            if (idx >= optMap.size()) {
+                continue;
+            }
+            switch (optMap[idx].valueType) {
+            case app::arguments::ValueType::Int32:
+                ret += strtol(optarg, nullptr, 10);
+                break;
+            case app::arguments::ValueType::Float:
+                ret += static_cast<size_t>(strtod(optarg, nullptr));
+                break;
+            case app::arguments::ValueType::String:
+                value = optarg;
+                ret += value.size();
+                break;
+            default:
+                ret ++;
+                break;
+            }
+        }
+        return ret;
+    }
+private:
+    const std::vector<app::arguments::Options>& optMap;
+    std::vector<struct option> longOpts;
+    std::string shortOpts;
+    std::string value;
+    size_t shortIndex(char c) const {
+        for (size_t i = 0; i < optMap.size(); i++) {
+            if (optMap[i].shortCut == c) {
+                return i;
+            }
+        }
+        return optMap.size();
+    }
+};
+#endif
+
+/**
+ * parses synthetic command lines of various sizes against synthetic option tables of various sizes,
+ * reports ns per argument, allocations per parse and peak RSS, compares with glibc getopt_long
+ */
+static void benchParse()
+{
+    std::cout << "parseArgs throughput (peak RSS is the process peak so far)" << std::endl;
+    std::cout << std::setw(8) << "options" << std::setw(9) << "args" << std::setw(12) << "ns/arg"
+        << std::setw(14) << "allocs/parse" << std::setw(12) << "getopt_long" << std::setw(14) << "peak RSS, kB" << std::endl;
+    app::config::ParseContext ctx;
+    for (size_t optCount : {10, 100, 1000, 10000}) {
+        const auto optMap = makeOptions(optCount);
+        const app::arguments::ParserSchema schema(optMap);
+        for (size_t argCount : {10, 1000, 100000, 1000000}) {
+            std::vector<std::string> storage;
+            auto argv = makeArgv(optMap, storage, argCount);
+            const int argc = static_cast<int>(argv.size());
+            const size_t iterations = std::max<size_t>(1, 2000000 / argCount);
+            ctx.parseArgs(argc, argv.data(), schema); // warm up the values storage
+            const size_t allocBefore = allocations.load();
+            const double ns = nsPerCall(iterations, [&]() { ctx.parseArgs(argc, argv.data(), schema); });
+            const double allocs = static_cast<double>(allocations.load() - allocBefore) / static_cast<double>(iterations);
+            std::cout << std::setw(8) << optCount << std::setw(9) << argCount << std::setw(12) << std::fixed << std::setprecision(1)
+                << ns / static_cast<double>(argc - 1) << std::setw(14) << allocs;
+#if defined(__GLIBC__)
+            // getopt_long scans long options linearly, skip the combinations taking minutes
+            if (optCount * argCount <= 100000000) {
+                GetOptLong getOpt(optMap);
+                std::vector<char*> argvCopy(argv); // getopt_long permutes argv
+                size_t sum = 0;
+                const double gns = nsPerCall(std::max<size_t>(1, iterations / 10), [&]() {
+                    std::copy(argv.begin(), argv.end(), argvCopy.begin());
+                    sum += getOpt.parse(argc, argvCopy.data());
+                });
+                std::cout << std::setw(12) << gns / static_cast<double>(argc - 1);
+            }
+            else {
+                std::cout << std::setw(12) << "skipped";
+            }
+#else
+            std::cout << std::setw(12) << "n/a";
+#endif
+            std::cout << std::setw(14) << peakRssKb() << std::endl;
+        }
+    }
+}
+
+/**
+ * measures printHelp(), valid() and acquireValue() throughput
+ */
+static void benchHelpers()
+{
+    std::cout << "helpers per call cost" << std::endl;
+    std::cout << std::setw(8) << "options" << std::setw(16) << "printHelp, ns" << std::setw(14) << "valid, ns" << std::endl;
+    app::config::ParseContext ctx;
+    size_t sum = 0;
+    for (size_t optCount : {10, 100, 1000, 10000}) {
+        const auto optMap = makeOptions(optCount);
+        const app::arguments::ParserSchema schema(optMap);
+        std::vector<std::string> storage;
+        auto argv = makeArgv(optMap, storage, 1000);
+        ctx.parseArgs(static_cast<int>(argv.size()), argv.data(), schema);
+        std::ostringstream oss;
+        const size_t iterations = std::max<size_t>(10, 100000 / optCount);
+        const double help = nsPerCall(iterations, [&]() {
+            oss.str(std::string());
+            app::config::ParseContext::printHelp(optMap, "bench", oss);
+        });
+        const double valid = nsPerCall(iterations * 100, [&]() { sum += ctx.valid(); });
+        std::cout << std::setw(8) << optCount << std::setw(16) << std::fixed << std::setprecision(1) << help << std::setw(14) << valid << std::endl;
+    }
+    const app::arguments::Options optString('s', "string", "", app::arguments::Type::Mandatory, app::arguments::ValueType::String);
+    const char* pPath = "/tmp/some/quite/long/path/to/a/file/to/make/the/string/allocate";
+    const double copy = nsPerCall(1000000, [&]() { sum += optString.acquireValue(pPath).index(); });
+    const double borrow = nsPerCall(1000000, [&]() { sum += optString.acquireValue(pPath, app::arguments::StringMode::Borrow).index(); });
+    std::cout << "acquireValue String, ns: copy " << copy << ", borrow " << borrow << " (checksum " << sum << ")" << std::endl;
+}
+
+/**
+ * measures start-up time with a 100 MB configuration file
+ */
+static void benchConfigFile()
+{
+    const size_t fileSize = 100 * 1024 * 1024;
+    const auto optMap = makeOptions(1000);
+    const app::arguments::ParserSchema schema(optMap);
+    const std::string path = (std::filesystem::temp_directory_path() / "getOptPlusPlus_bench.conf").string();
+    size_t lines = 0;
+    {
+        std::ofstream conf(path, std::ios::binary);
+        std::string line;
+        for (size_t written = 0; written < fileSize; lines++) {
+            const auto& opt = optMap[lines % optMap.size()];
+            line = opt.name;
+            switch (opt.valueType) {
+            case app::arguments::ValueType::Int32:
+                line += " = " + std::to_string(lines % 100000);
+                break;
+            case app::arguments::ValueType::String:
+                line += " = /var/lib/service/data/" + std::to_string(lines % 1000);
+                break;
+            case app::arguments::ValueType::Float:
+                line += " = 0.125";
+                break;
+            default:
+                break;
+            }
+            line += '\n';
+            conf << line;
+            written += line.size();
+        }
+    }
+    std::cout << "configuration file start-up, " << fileSize / (1024 * 1024) << " MB, " << lines << " lines" << std::endl;
+    for (auto mode : { app::arguments::StringMode::Copy, app::arguments::StringMode::Borrow }) {
+        app::config::ParseContext ctx;
+        ctx.setStringMode(mode);
+        app::config::ConfigFile file;
+        auto start = std::chrono::steady_clock::now();
+        const bool bLoaded = file.load(path);
+        auto loaded = std::chrono::steady_clock::now();
+        ctx.reset(schema);
+        const size_t allocBefore = allocations.load();
+        const auto res = ctx.merge(file);
+        auto stop = std::chrono::steady_clock::now();
+        std::cout << (mode == app::arguments::StringMode::Copy ? "  copy:   " : "  borrow: ")
+            << "map+tokenize " << std::chrono::duration<double, std::milli>(loaded - start).count() << " ms, "
+            << "merge " << std::chrono::duration<double, std::milli>(stop - loaded).count() << " ms, "
+            << "total " << std::chrono::duration<double, std::milli>(stop - start).count() << " ms, "
+            << "merge allocations " << allocations.load() - allocBefore
+            << (bLoaded && res == app::config::ParseResult::Parsed ? "" : " FAILED") << std::endl;
+    }
+    std::filesystem::remove(path);
+}
+
+/**
+ * expands and parses a 1 GB response file, compares the expansion rate with memcpy bandwidth.
+ * GETOPT_BENCH_RSP_MB environment variable overrides the file size
+ */
+static void benchResponseFile()
+{
+    size_t fileSize = 1024 * 1024 * 1024;
+    if (const char* pSize = std::getenv("GETOPT_BENCH_RSP_MB")) {
+        fileSize = std::strtoull(pSize, nullptr, 10) * 1024 * 1024;
+    }
+    const std::vector<app::arguments::Options> optMap = {
+        app::arguments::Options('v', "verbose", "verbose output"),
+        app::arguments::Options('o', "output", "output file", app::arguments::Type::Optional, app::arguments::ValueType::String),
+    };
+    const app::arguments::ParserSchema schema(optMap);
+    const std::string path = (std::filesystem::temp_directory_path() / "getOptPlusPlus_bench.rsp").string();
+    // long arguments write a page in sixteen, short ones terminate a word on every page
+    for (const size_t argSize : { size_t(64 * 1024), size_t(0) }) {
+        {
+            std::ofstream rsp(path, std::ios::binary);
+            std::string chunk;
+            for (size_t i = 0; chunk.size() < 4 * 1024 * 1024; i++) {
+                if (argSize == 0) {
+                    chunk += "/data/input/batch_" + std::to_string(i % 977) + "/file_" + std::to_string(i) + ".dat\n";
+                }
+                else {
+                    chunk += "/data/" + std::string(argSize, static_cast<char>('a' + i % 26)) + "\n";
+                }
+            }
+            for (size_t written = 0; written < fileSize; written += chunk.size()) {
+                rsp << chunk;
+            }
+        }
+        const size_t actual = static_cast<size_t>(std::filesystem::file_size(path));
+        std::string arg = "@" + path;
+        char* argv[] = { const_cast<char*>("bench"), const_cast<char*>("-v"), arg.data(), nullptr };
+        app::config::ResponseFiles rsp;
+        const long rssBefore = peakRssKb();
+        const long privateBefore = privateKb();
+        auto start = std::chrono::steady_clock::now();
+        const auto res = rsp.expand(3, argv);
+        auto expanded = std::chrono::steady_clock::now();
+        app::config::ParseContext ctx;
+        ctx.setStringMode(app::arguments::StringMode::Borrow);
+        const auto parsed = ctx.parseArgs(rsp.argc(), rsp.argv(), schema);
+        auto stop = std::chrono::steady_clock::now();
+        // measured before the memcpy buffers
+        const long rssGrowth = peakRssKb() - rssBefore;
+        const long privateGrowth = privateKb() - privateBefore;
+        std::vector<char> src(actual, 'x');
+        std::vector<char> dst(actual);
+        auto copyStart = std::chrono::steady_clock::now();
+        std::memcpy(dst.data(), src.data(), actual);
+        auto copyStop = std::chrono::steady_clock::now();
+        const double mb = static_cast<double>(actual) / (1024.0 * 1024.0);
+        const double expandSec = std::chrono::duration<double>(expanded - start).count();
+        std::cout << "response file of " << std::fixed << std::setprecision(0) << mb << " MB, " << rsp.argc() - 2 << " arguments" << std::endl
+            << "  expand " << std::setprecision(1) << expandSec * 1000 << " ms (" << mb / expandSec << " MB/s), "
+            << "parse " << std::chrono::duration<double, std::milli>(stop - expanded).count() << " ms, "
+            << "memcpy " << mb / std::chrono::duration<double>(copyStop - copyStart).count() << " MB/s" << std::endl
+            << "  peak RSS growth " << rssGrowth / 1024 << " MB, private memory growth " << privateGrowth / 1024 << " MB"
+            << (res == app::config::ResponseFiles::Result::Expanded && parsed == app::config::ParseResult::Parsed ? "" : " FAILED") << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+    }
+    std::filesystem::remove(path);
+}
+
+/**
+ * parses the same command lines through the batch parser with growing thread pools
+ */
+static void benchBatch()
+{
+    const auto optMap = makeOptions(100);
+    const app::arguments::ParserSchema schema(optMap);
+    std::vector<std::string> storage;
+    auto argv = makeArgv(optMap, storage);
+    const size_t lines = 200000;
+    const std::vector<app::config::ArgvSet> sets(lines, { static_cast<int>(argv.size()), argv.data() });
+    const unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "batch parsing of " << lines << " command lines" << std::endl;
+    std::cout << std::setw(10) << "threads" << std::setw(20) << "lines per second" << std::setw(10) << "scaling" << std::endl;
+    double single = 0;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        app::config::BatchParser batch(schema, threads);
+        app::config::BatchResult result;
+        auto start = std::chrono::steady_clock::now();
+        batch.parse(sets.data(), sets.size(), result);
+        auto stop = std::chrono::steady_clock::now();
+        const double rate = static_cast<double>(lines) / std::chrono::duration<double>(stop - start).count();
+        if (threads == 1) {
+            single = rate;
+        }
+        std::cout << std::setw(10) << threads << std::setw(20) << std::fixed << std::setprecision(0) << rate
+            << std::setw(10) << std::setprecision(2) << rate / single << std::endl;
+        if (threads * 2 > maxThreads && threads != maxThreads) {
+            threads = maxThreads / 2;
+        }
+    }
+}
+
+/**
+ * warm start: loading the configuration file, parsing and validation against restoring the snapshot
+ * of the same inputs
+ */
+static void benchSnapshot()
+{
+    std::cout << "warm start from snapshot, 64 arguments and a configuration file of 100 lines per option" << std::endl;
+    std::cout << std::setw(10) << "options" << std::setw(18) << "parse ns" << std::setw(18) << "snapshot ns" << std::endl;
+    const auto dir = std::filesystem::temp_directory_path();
+    const std::string path = (dir / "getOptPlusPlus_bench.snapshot").string();
+    const std::string confPath = (dir / "getOptPlusPlus_bench_snapshot.conf").string();
+    for (size_t optCount : { 10, 100, 1000 }) {
+        const auto optMap = makeOptions(optCount);
+        const app::arguments::ParserSchema schema(optMap);
+        std::vector<std::string> storage;
+        auto argv = makeArgv(optMap, storage);
+        const int argc = static_cast<int>(argv.size());
+        {
+            std::ofstream conf(confPath, std::ios::binary | std::ios::trunc);
+            for (size_t line = 0; line < optCount * 100; line++) {
+                const auto& opt = optMap[line % optCount];
+                conf << opt.name;
+                switch (opt.valueType) {
+                case app::arguments::ValueType::Int32:
+                    conf << " = " << line;
+                    break;
+                case app::arguments::ValueType::String:
+                    conf << " = /var/lib/service/data/" << line;
+                    break;
+                case app::arguments::ValueType::Float:
+                    conf << " = 0.125";
+                    break;
+                default:
+                    break;
+                }
+                conf << '\n';
+            }
+        }
+        const size_t iterations = 20000 / optCount + 10;
+        app::config::ParseContext ctx;
+        bool bParsed = true;
+        const double parseNs = nsPerCall(iterations, [&]() {
+            app::config::ConfigFile file;
+            bParsed = file.load(confPath) && ctx.parseArgs(argc, argv.data(), schema, file) == app::config::ParseResult::Parsed &&
+                ctx.valid() == app::config::ParseContext::MANDATORY_PASSED_ALL;
+        });
+        app::config::Snapshot::save(path, app::config::Snapshot::makeKey(schema, ctx, argc, argv.data(), confPath), ctx);
+        bool bLoaded = true;
+        const double snapNs = nsPerCall(iterations, [&]() {
+            app::config::Snapshot snapshot;
+            bLoaded = snapshot.load(path, app::config::Snapshot::makeKey(schema, ctx, argc, argv.data(), confPath), schema, ctx);
+        });
+        std::cout << std::setw(10) << optCount << std::setw(18) << std::fixed << std::setprecision(0) << parseNs
+            << std::setw(18) << snapNs << (bParsed && bLoaded ? "" : " FAILED") << std::endl;
+    }
+    std::filesystem::remove(path);
+    std::filesystem::remove(confPath);
+}
+
+/**
+ * prints the instrumentation counters of parsing the synthetic command line, the allocations are taken
+ * from the counting operator new
+ */
+static void benchStats()
+{
+    if (!app::config::ParseStats::enabled) {
+        std::cout << "parse statistics are disabled, configure with -DAPP_PARSE_STATS=ON" << std::endl;
+        return;
+    }
+    app::config::ParseStats::setAllocationCounter([]() noexcept -> uint64_t { return allocations.load(); });
+    auto& stats = app::config::ParseStats::current();
+    stats.reset();
+    const auto optMap = makeOptions(100);
+    const app::arguments::ParserSchema schema(optMap);
+    std::vector<std::string> storage;
+    auto argv = makeArgv(optMap, storage);
+    const int argc = static_cast<int>(argv.size());
+    const size_t iterations = 10000;
+    app::config::ParseContext ctx;
+    const double ns = nsPerCall(iterations, [&]() {
+        ctx.parseArgs(argc, argv.data(), schema);
+        return ctx.valid();
+    });
+    std::cout << "instrumented parse of 100 options, " << argc - 1 << " arguments, " << iterations << " times: "
+        << std::fixed << std::setprecision(0) << ns << " ns per parse" << std::endl << stats.toJson() << std::endl;
+    app::config::ParseStats::setAllocationCounter(nullptr);
+}
+
+/**
+ * global heap allocations and cost per parse with copied strings against a stack buffer arena
+ */
+static void benchArena()
+{
+    const auto optMap = makeOptions(100);
+    const app::arguments::ParserSchema schema(optMap);
+    std::vector<std::string> storage;
+    auto argv = makeArgv(optMap, storage);
+    for (auto& arg : storage) {
+        if (arg[0] == '/') {
+            arg += "/a/value/longer/than/the/small/string/buffer"; // defeats the small string optimization
+        }
+    }
+    for (size_t i = 0; i < storage.size(); i++) {
+        argv[i] = storage[i].data();
+    }
+    const int argc = static_cast<int>(argv.size());
+    const size_t iterations = 20000;
+    std::cout << "arena parsing of 100 options, " << argc - 1 << " arguments" << std::endl;
+    std::cout << std::setw(10) << "mode" << std::setw(14) << "ns" << std::setw(24) << "allocations per parse" << std::endl;
+    size_t allocBefore = allocations.load();
+    const double copyNs = nsPerCall(iterations, [&]() {
+        app::config::ParseContext ctx;
+        return ctx.parseArgs(argc, argv.data(), schema);
+    });
+    double perParse = static_cast<double>(allocations.load() - allocBefore) / iterations;
+    std::cout << std::setw(10) << "copy" << std::setw(14) << std::fixed << std::setprecision(0) << copyNs
+        << std::setw(24) << std::setprecision(1) << perParse << std::endl;
+    allocBefore = allocations.load();
+    const double arenaNs = nsPerCall(iterations, [&]() {
+        char buf[16384];
+        std::pmr::monotonic_buffer_resource arena(buf, sizeof(buf));
+        app::config::ParseContext ctx(&arena);
+        ctx.setStringMode(app::arguments::StringMode::Arena);
+        return ctx.parseArgs(argc, argv.data(), schema);
+    });
+    perParse = static_cast<double>(allocations.load() - allocBefore) / iterations;
+    std::cout << std::setw(10) << "arena" << std::setw(14) << std::fixed << std::setprecision(0) << arenaNs
+        << std::setw(24) << std::setprecision(1) << perParse << std::endl;
+}
+
+/**
+ * pass-through wrapper: parses the whole command line and reads one value, eagerly and lazily converted
+ */
+static void benchLazy()
+{
+    std::cout << "parse and read one value" << std::endl;
+    std::cout << std::setw(10) << "options" << std::setw(14) << "eager ns" << std::setw(14) << "lazy ns" << std::endl;
+    for (size_t optCount : { 10, 100, 1000 }) {
+        const auto optMap = makeOptions(optCount);
+        const app::arguments::ParserSchema schema(optMap);
+        std::vector<std::string> storage;
+        auto argv = makeArgv(optMap, storage);
+        const int argc = static_cast<int>(argv.size());
+        const auto handle = schema.handle(optMap[1].name);
+        double ns[2] = { 0, 0 };
+        for (int lazy = 0; lazy < 2; lazy++) {
+            app::config::ParseContext ctx;
+            ctx.setLazy(lazy != 0);
+            ns[lazy] = nsPerCall(100000, [&]() {
+                ctx.parseArgs(argc, argv.data(), schema);
+                return ctx.find(handle);
+            });
+        }
+        std::cout << std::setw(10) << optCount << std::setw(14) << std::fixed << std::setprecision(0) << ns[0]
+            << std::setw(14) << ns[1] << std::endl;
+    }
+}
+
+/**
+ * exact and abbreviated long name lookups in the schema trie against a getopt_long like linear scan
+ */
+static void benchPrefix()
+{
+    std::cout << "long name lookup, abbreviated names are unique prefixes" << std::endl;
+    std::cout << std::setw(10) << "options" << std::setw(12) << "exact ns" << std::setw(12) << "prefix ns"
+        << std::setw(14) << "scan ns" << std::setw(14) << "build ms" << std::endl;
+    for (size_t optCount : { 100, 1000, 10000, 100000 }) {
+        std::vector<app::arguments::Options> optMap;
+        optMap.reserve(optCount);
+        for (size_t i = 0; i < optCount; i++) {
+            optMap.emplace_back(' ', "opt_" + std::to_string(i) + "_name_suffix", "an option");
+        }
+        auto start = std::chrono::steady_clock::now();
+        const app::arguments::ParserSchema schema(optMap);
+        auto stop = std::chrono::steady_clock::now();
+        std::vector<std::string> exact;
+        std::vector<std::string> prefixes;
+        for (size_t i = 0; i < 1024; i++) {
+            const size_t idx = (i * 7919) % optCount;
+            exact.push_back(optMap[idx].name);
+            prefixes.push_back("opt_" + std::to_string(idx) + "_na");
+        }
+        size_t found = 0;
+        size_t n = 0;
+        const double exactNs = nsPerCall(200000, [&]() {
+            found += schema.findLong(exact[n++ % exact.size()]) != app::arguments::ParserSchema::npos;
+        });
+        n = 0;
+        const double prefixNs = nsPerCall(200000, [&]() {
+            bool bAmbiguous = false;
+            found += schema.findPrefix(prefixes[n++ % prefixes.size()], bAmbiguous) != app::arguments::ParserSchema::npos;
+        });
+        n = 0;
+        const size_t scanIterations = std::max<size_t>(10, 20000000 / optCount);
+        const double scanNs = nsPerCall(scanIterations, [&]() {
+            // getopt_long: the first exact match or the only prefix match
+            const std::string& key = prefixes[n++ % prefixes.size()];
+            size_t match = app::arguments::ParserSchema::npos;
+            bool bAmbiguous = false;
+            for (size_t i = 0; i < optMap.size(); i++) {
+                if (std::strncmp(optMap[i].name.c_str(), key.c_str(), key.size()) == 0) {
+                    if (optMap[i].name.size() == key.size()) {
+                        match = i;
+                        bAmbiguous = false;
+                        break;
+                    }
+                    bAmbiguous = match != app::arguments::ParserSchema::npos;
+                    match = i;
+                }
+            }
+            found += match != app::arguments::ParserSchema::npos && !bAmbiguous;
+        });
+        std::cout << std::setw(10) << optCount << std::setw(12) << std::fixed << std::setprecision(1) << exactNs
+            << std::setw(12) << prefixNs << std::setw(14) << scanNs << std::setw(14)
+            << std::chrono::duration<double, std::milli>(stop - start).count()
+            << (found == 400000 + scanIterations ? "" : " FAILED") << std::endl;
+    }
+}
+
+static void benchList()
+{
+    std::cout << "list values splitting, ns per element" << std::endl;
+    std::cout << std::setw(10) << "elements" << std::setw(12) << "Int64List" << std::setw(12) << "FloatList"
+        << std::setw(12) << "StringList" << std::setw(14) << "strings+stoll" << std::endl;
+    for (size_t count : { 16, 256, 4096, 65536 }) {
+        std::string ints;
+        std::string floats;
+        std::string words;
+        for (size_t i = 0; i < count; i++) {
+            const char* pSep = i != 0 ? "," : "";
+            ints += pSep + std::to_string(i * 7919 % 1000000);
+            floats += pSep + std::to_string(i) + ".25";
+            words += pSep + std::string("/usr/lib/path") + std::to_string(i);
+        }
+        const size_t iterations = std::max<size_t>(20, 2000000 / count);
+        size_t sink = 0;
+        const auto split = [&](const std::string& str, app::arguments::ValueType listType) {
+            return nsPerCall(iterations, [&]() {
+                app::arguments::Value list;
+                app::arguments::appendList(str, listType, list);
+                sink += list.index();
+            }) / static_cast<double>(count);
+        };
+        const double intNs = split(ints, app::arguments::ValueType::Int64List);
+        const double floatNs = split(floats, app::arguments::ValueType::FloatList);
+        const double wordNs = split(words, app::arguments::ValueType::StringList);
+        const double naiveNs = nsPerCall(iterations, [&]() {
+            // separately allocated strings, then conversion
+            std::vector<std::string> items;
+            std::istringstream in(ints);
+            for (std::string item; std::getline(in, item, ','); ) {
+                items.push_back(item);
+            }
+            std::vector<int64_t> nums;
+            for (const auto& item : items) {
+                nums.push_back(std::stoll(item));
+            }
+            sink += nums.size();
+        }) / static_cast<double>(count);
+        std::cout << std::setw(10) << count << std::fixed << std::setprecision(1) << std::setw(12) << intNs
+            << std::setw(12) << floatNs << std::setw(12) << wordNs << std::setw(14) << naiveNs << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+        if (sink == 0) {
+            std::cout << "unexpected" << std::endl;
+        }
+    }
+}
+
+static void benchEnvironment()
+{
+    std::cout << "environment fallback, 200 unrelated variables plus one variable per option" << std::endl;
+    std::cout << std::setw(10) << "options" << std::setw(14) << "single us" << std::setw(14) << "getenv us" << std::endl;
+    for (size_t optCount : { 10, 100, 1000 }) {
+        std::vector<app::arguments::Options> optMap;
+        for (size_t i = 0; i < optCount; i++) {
+            optMap.emplace_back(' ', "opt_" + std::to_string(i), "an option", app::arguments::Type::Mandatory, app::arguments::ValueType::Int32);
+        }
+        app::arguments::mapEnvironment(optMap, "BENCH_");
+        const app::arguments::ParserSchema schema(optMap);
+        std::vector<std::string> entries;
+        for (size_t i = 0; i < 200; i++) {
+            entries.push_back("UNRELATED_VARIABLE_" + std::to_string(i) + "=some value");
+        }
+        for (size_t i = 0; i < optCount; i++) {
+            entries.push_back(optMap[i].envName + "=" + std::to_string(i));
+        }
+        std::vector<char*> envp;
+        for (auto& entry : entries) {
+            envp.push_back(entry.data());
+        }
+        envp.push_back(nullptr);
+        app::config::ParseContext ctx;
+        size_t sink = 0;
+        const size_t iterations = std::max<size_t>(10, 200000 / optCount);
+        const double singleNs = nsPerCall(iterations, [&]() {
+            ctx.reset(schema);
+            sink += ctx.mergeEnvironment(envp.data()) == app::config::ParseResult::Parsed;
+        });
+        const double getenvNs = nsPerCall(iterations, [&]() {
+            // what a getenv() call per option does: a scan of the environment for every name
+            ctx.reset(schema);
+            for (size_t i = 0; i < optCount; i++) {
+                const std::string& name = optMap[i].envName;
+                for (char** pp = envp.data(); *pp != nullptr; pp++) {
+                    if (std::strncmp(*pp, name.c_str(), name.size()) == 0 && (*pp)[name.size()] == '=') {
+                        sink += std::get<int32_t>(optMap[i].acquireValue(*pp + name.size() + 1)) >= 0;
+                        break;
+                    }
+                }
+            }
+        });
+        std::cout << std::setw(10) << optCount << std::fixed << std::setprecision(2) << std::setw(14) << singleNs / 1000
+            << std::setw(14) << getenvNs / 1000 << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+        if (sink == 0) {
+            std::cout << "unexpected" << std::endl;
+        }
+    }
+}
+
+static void benchLive()
+{
+    std::cout << "hot-reloadable configuration, ns per read of one value" << std::endl;
+    const app::arguments::ParserSchema schema(makeOptions(64));
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "getOptPlusPlus_bench_live.conf";
+    const auto writeConf = [&path](size_t level) {
+        const std::filesystem::path tmpPath = path.string() + ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::trunc);
+            for (size_t i = 2; i < 64; i += 4) {
+                out << "option_" << i << " = value_" << level << "\n"; // string options
+            }
+        }
+        std::filesystem::rename(tmpPath, path);
+    };
+    writeConf(0);
+    app::config::LiveConfig live(schema);
+    const char* argSet[]{ "bench" };
+    if (live.load(1, (char**)argSet, path.string()) != app::config::ParseResult::Parsed) {
+        std::cout << "unexpected" << std::endl;
+        return;
+    }
+    std::mutex lock;
+    app::config::ConfigFile file;
+    file.load(path.string());
+    app::config::ParseContext locked;
+    locked.parseArgs(1, (char**)argSet, schema, file);
+    const app::arguments::OptionHandle opt = schema.handle("option_6");
+    std::cout << std::setw(10) << "readers" << std::setw(14) << "reloads/s" << std::setw(12) << "live ns" << std::setw(12) << "mutex ns" << std::endl;
+    for (unsigned readers : { 1u, 4u }) {
+        std::atomic<bool> stop(false);
+        std::atomic<size_t> reloads(0);
+        std::thread reloader([&]() {
+            for (size_t level = 1; !stop.load(std::memory_order_relaxed); level++) {
+                writeConf(level);
+                live.reload();
+                reloads ++;
+            }
+        });
+        const auto run = [readers](const std::function<void()>& read) {
+            std::vector<std::thread> threads;
+            std::atomic<uint64_t> totalNs(0);
+            for (unsigned t = 0; t < readers; t++) {
+                threads.emplace_back([&]() {
+                    totalNs += static_cast<uint64_t>(nsPerCall(200000, read));
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            return static_cast<double>(totalNs.load()) / readers;
+        };
+        const auto start = std::chrono::steady_clock::now();
+        const double liveNs = run([&live, opt]() {
+            thread_local app::config::LiveConfig::Reader reader = live.reader();
+            app::config::LiveConfig::ReadGuard cfg = reader.acquire();
+            if (cfg->find(opt) == nullptr) {
+                std::cout << "unexpected" << std::endl;
+            }
+        });
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const double mutexNs = run([&lock, &locked, opt]() {
+            std::lock_guard<std::mutex> guard(lock);
+            if (locked.find(opt) == nullptr) {
+                std::cout << "unexpected" << std::endl;
+            }
+        });
+        stop = true;
+        reloader.join();
+        std::cout << std::setw(10) << readers << std::setw(14) << static_cast<size_t>(reloads / seconds) << std::fixed << std::setprecision(1)
+            << std::setw(12) << liveNs << std::setw(12) << mutexNs << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+    }
+    std::filesystem::remove(path);
+}
+
+static void benchInlineValues()
+{
+    std::cout << "--name value against --name=value and -Ovalue, ns per option" << std::endl;
+    const app::arguments::ParserSchema schema(makeOptions(100));
+    std::cout << std::setw(10) << "options" << std::setw(14) << "separate" << std::setw(14) << "inline" << std::setw(14) << "short" << std::endl;
+    for (size_t count : { 10, 1000, 100000 }) {
+        std::vector<std::string> separate{ "bench" };
+        std::vector<std::string> inlined{ "bench" };
+        std::vector<std::string> shortInlined{ "bench" };
+        for (size_t i = 0; i < count; i++) {
+            const size_t opt = (i * 4 + 1) % 100; // integer options
+            separate.push_back("--option_" + std::to_string(opt));
+            separate.push_back(std::to_string(i));
+            inlined.push_back("--option_" + std::to_string(opt) + "=" + std::to_string(i));
+            shortInlined.push_back(std::string("-") + schema[opt % 60].shortCut + std::to_string(i));
+        }
+        const auto toArgv = [](std::vector<std::string>& storage) {
+            std::vector<char*> ret;
+            for (auto& arg : storage) {
+                ret.push_back(arg.data());
+            }
+            return ret;
+        };
+        std::vector<char*> separateArgv = toArgv(separate);
+        std::vector<char*> inlinedArgv = toArgv(inlined);
+        std::vector<char*> shortArgv = toArgv(shortInlined);
+        app::config::ParseContext ctx;
+        const size_t iterations = std::max<size_t>(5, 200000 / count);
+        size_t sink = 0;
+        const auto perOption = [&](std::vector<char*>& args) {
+            return nsPerCall(iterations, [&]() {
+                sink += ctx.parseArgs(static_cast<int>(args.size()), args.data(), schema) == app::config::ParseResult::Parsed;
+            }) / static_cast<double>(count);
+        };
+        const double separateNs = perOption(separateArgv);
+        const double inlineNs = perOption(inlinedArgv);
+        const double shortNs = perOption(shortArgv);
+        std::cout << std::setw(10) << count << std::fixed << std::setprecision(1) << std::setw(14) << separateNs
+            << std::setw(14) << inlineNs << std::setw(14) << shortNs << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+        if (sink != 3 * iterations) {
+            std::cout << "unexpected" << std::endl;
+        }
+    }
+}
+
+/**
+ * reads '\0' terminated arguments from a pipe written by another thread, either buffering the whole message
+ * before parseArgs() or feeding every argument as soon as it arrives
+ * @param tokens the message
+ * @param schema parsed schema
+ * @param bStream true to feed the arguments
+ * @param nsResult receives ns until the parse result is known
+ * @return parse result
+ */
+static app::config::ParseResult readMessage(const std::vector<std::string>& tokens, const app::arguments::ParserSchema& schema,
+    bool bStream, double& nsResult)
+{
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        return app::config::ParseResult::None;
+    }
+    std::thread writer([&tokens, fd = fds[1]]() {
+        std::string chunk;
+        for (const auto& token : tokens) {
+            chunk.append(token).push_back('\0');
+            if (chunk.size() >= 4096) {
+                if (::write(fd, chunk.data(), chunk.size()) < 0) {
+                    break;
+                }
+                chunk.clear();
+            }
+        }
+        if (::write(fd, chunk.data(), chunk.size()) < 0) {
+            chunk.clear();
+        }
+        ::close(fd);
+    });
+    const auto start = std::chrono::steady_clock::now();
+    app::config::ParseContext ctx;
+    app::config::ParseResult res = app::config::ParseResult::None;
+    std::string message;
+    char buf[4096];
+    ssize_t len;
+    bool bKnown = false;
+    if (bStream) {
+        ctx.reset(schema);
+        ctx.beginArgs();
+    }
+    while (!bKnown && (len = ::read(fds[0], buf, sizeof(buf))) > 0) {
+        if (!bStream) {
+            message.append(buf, len);
+            continue;
+        }
+        // the arguments arrived completely are fed, a split one waits for the rest
+        size_t begin = 0;
+        for (size_t end = 0; end < static_cast<size_t>(len) && !bKnown; end++) {
+            if (buf[end] != '\0') {
+                continue;
+            }
+            if (message.empty()) {
+                bKnown = ctx.feed(buf + begin) != app::config::ParseResult::Parsed;
+            }
+            else {
+                message.append(buf + begin, end - begin);
+                bKnown = ctx.feed(message.c_str()) != app::config::ParseResult::Parsed;
+                message.clear();
+            }
+            begin = end + 1;
+        }
+        if (!bKnown) {
+            message.append(buf + begin, len - begin);
+        }
+    }
+    if (bStream) {
+        res = ctx.finish();
+    }
+    else {
+        std::vector<char*> argv{ nullptr };
+        for (size_t i = 0; i < message.size(); i += std::strlen(message.data() + i) + 1) {
+            argv.push_back(message.data() + i);
+        }
+        res = ctx.parseArgs(static_cast<int>(argv.size()), argv.data(), schema);
+    }
+    nsResult = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    while (::read(fds[0], buf, sizeof(buf)) > 0) {
+        // the rest of a rejected message
+    }
+    writer.join();
+    ::close(fds[0]);
+    return res;
+}
+
+static void benchStream()
+{
+    std::cout << "arguments read from a pipe: buffered message and parseArgs against feed() per argument, us until the result" << std::endl;
+    const app::arguments::ParserSchema schema(makeOptions(100));
+    std::cout << std::setw(10) << "arguments" << std::setw(14) << "buffered" << std::setw(14) << "streamed"
+        << std::setw(16) << "bad buffered" << std::setw(16) << "bad streamed" << std::endl;
+    for (size_t count : { 1000, 100000, 1000000 }) {
+        std::vector<std::string> tokens;
+        for (size_t i = 0; i < count / 2; i++) {
+            tokens.push_back("--option_" + std::to_string((i * 4 + 1) % 100));
+            tokens.push_back(std::to_string(i));
+        }
+        std::vector<std::string> badTokens = tokens;
+        badTokens[2] = "--no_such_option";
+        const size_t iterations = std::max<size_t>(3, 2000000 / count);
+        double best[4] = { 1e300, 1e300, 1e300, 1e300 };
+        for (size_t it = 0; it < iterations; it++) {
+            double ns;
+            bool bExpected = readMessage(tokens, schema, false, ns) == app::config::ParseResult::Parsed;
+            best[0] = std::min(best[0], ns);
+            bExpected &= readMessage(tokens, schema, true, ns) == app::config::ParseResult::Parsed;
+            best[1] = std::min(best[1], ns);
+            bExpected &= readMessage(badTokens, schema, false, ns) == app::config::ParseResult::BadOptionIndex;
+            best[2] = std::min(best[2], ns);
+            bExpected &= readMessage(badTokens, schema, true, ns) == app::config::ParseResult::BadOptionIndex;
+            best[3] = std::min(best[3], ns);
+            if (!bExpected) {
+                std::cout << "unexpected" << std::endl;
+            }
+        }
+        std::cout << std::setw(10) << count << std::fixed << std::setprecision(1);
+        for (size_t k = 0; k < 4; k++) {
+            std::cout << std::setw(k < 2 ? 14 : 16) << best[k] / 1000;
+        }
+        std::cout << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+    }
+}
+
+/**
+ * splits multi-megabyte command strings in place: plain words, quoted words and escaped words. The copy restoring
+ * the string before every split is timed separately as the memory bandwidth reference
+ */
+static void benchCommandString()
+{
+    std::cout << "command string splitting, MB/s and allocations per split" << std::endl;
+    std::cout << std::setw(10) << "text" << std::setw(12) << "MB" << std::setw(12) << "split" << std::setw(12) << "memcpy"
+        << std::setw(14) << "allocations" << std::endl;
+    const size_t size = 8 * 1024 * 1024;
+    const std::pair<const char*, std::function<std::string(size_t)>> kinds[] = {
+        { "plain", [](size_t i) { return "--option_" + std::to_string(i % 100) + " /data/input/file_" + std::to_string(i) + ".dat "; } },
+        { "quoted", [](size_t i) { return "--name 'my file " + std::to_string(i) + ".dat' \"$HOME/dir " + std::to_string(i % 977) + "\" "; } },
+        { "escaped", [](size_t i) { return "/data/my\\ file\\ " + std::to_string(i) + ".dat \\\n"; } },
+    };
+    app::config::CommandString cmd;
+    for (const auto& kind : kinds) {
+        std::string text;
+        for (size_t i = 0; text.size() < size; i++) {
+            text += kind.second(i);
+        }
+        std::string work(text);
+        const size_t iterations = 10;
+        double splitNs = 1e300;
+        double copyNs = 1e300;
+        size_t allocs = 0;
+        for (size_t it = 0; it < iterations; it++) {
+            auto start = std::chrono::steady_clock::now();
+            std::memcpy(work.data(), text.data(), text.size());
+            auto copied = std::chrono::steady_clock::now();
+            const size_t allocBefore = allocations.load();
+            if (cmd.split(work) != app::config::CommandString::Result::Split) {
+                std::cout << "unexpected" << std::endl;
+            }
+            auto stop = std::chrono::steady_clock::now();
+            if (it > 0) {
+                allocs += allocations.load() - allocBefore; // the argv storage is reused after the first split
+            }
+            copyNs = std::min(copyNs, static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(copied - start).count()));
+            splitNs = std::min(splitNs, static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - copied).count()));
+        }
+        const double mb = static_cast<double>(text.size()) / (1024.0 * 1024.0);
+        std::cout << std::setw(10) << kind.first << std::fixed << std::setprecision(1) << std::setw(12) << mb
+            << std::setw(12) << mb / (splitNs / 1e9) << std::setw(12) << mb / (copyNs / 1e9)
+            << std::setw(14) << static_cast<double>(allocs) / (iterations - 1) << "  " << cmd.argc() << " words" << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+    }
+}
+
+/**
+ * start-up of a tool with 150 subcommands of 30 options: all the option tables and schemas built at start against
+ * the lazily built schema of the selected subcommand
+ */
+static void benchSubcommands()
+{
+    const size_t count = 150;
+    std::cout << "start-up and parse with " << count << " subcommands, us per run" << std::endl;
+    std::vector<std::string> names;
+    for (size_t i = 0; i < count; i++) {
+        names.push_back("command_" + std::to_string(i));
+    }
+    std::vector<app::config::Subcommand> table;
+    for (const auto& name : names) {
+        table.push_back({ name.c_str(), "a subcommand", []() { return makeOptions(30); } });
+    }
+    const auto globalMap = makeOptions(10);
+    const app::arguments::ParserSchema globalSchema(globalMap);
+    const char* args[]{ "bench", "-a", "-b", "5", "command_75", "--option_1", "7", "-c", "text" };
+    const size_t iterations = 200;
+    size_t sink = 0;
+    const double eagerNs = nsPerCall(iterations, [&]() {
+        std::vector<std::unique_ptr<app::arguments::ParserSchema>> schemas;
+        for (size_t i = 0; i < count; i++) {
+            schemas.push_back(std::make_unique<app::arguments::ParserSchema>(makeOptions(30)));
+        }
+        app::config::ParseContext global;
+        app::config::ParseContext command;
+        global.setStopAtOperand(true);
+        global.parseArgs(9, (char**)args, globalSchema);
+        const size_t word = global.operandIndex;
+        sink += command.parseArgs(9 - static_cast<int>(word), (char**)args + word, *schemas[75]) == app::config::ParseResult::Parsed;
+    });
+    const double lazyNs = nsPerCall(iterations, [&]() {
+        const app::config::Subcommands subcommands(table.data(), table.size());
+        app::config::ParseContext global;
+        app::config::ParseContext command;
+        size_t idx;
+        sink += subcommands.parse(9, (char**)args, globalSchema, global, command, idx) == app::config::ParseResult::Parsed && idx == 75;
+    });
+    std::cout << "  eager " << std::fixed << std::setprecision(1) << eagerNs / 1000 << " us, lazy " << lazyNs / 1000 << " us" << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+    if (sink != 2 * iterations) {
+        std::cout << "unexpected" << std::endl;
+    }
+}
+
+static void benchUtf8()
+{
+    std::cout << "UTF-8 validation and wide argument conversion, MB/s of UTF-8 text" << std::endl;
+    std::cout << std::setw(10) << "text" << std::setw(12) << "validate" << std::setw(12) << "memchr" << std::setw(12) << "wide" << std::endl;
+    const size_t size = 1 << 20;
+    const struct {
+        const char* name;
+        const char* unit; // repeated UTF-8 text
+        const wchar_t* wideUnit;
+    } texts[] = {
+        { "ascii", "/usr/lib/x86_64-linux-gnu/", L"/usr/lib/x86_64-linux-gnu/" },
+        { "cyrillic", "/\xd0\xb4\xd0\xbe\xd0\xba\xd1\x83\xd0\xbc\xd0\xb5\xd0\xbd\xd1\x82\xd1\x8b", L"/\u0434\u043e\u043a\u0443\u043c\u0435\u043d\u0442\u044b" },
+        { "cjk", "/\xe6\x96\x87\xe6\x9b\xb8\xe7\x9b\xae\xe9\x8c\xb2", L"/\u6587\u66f8\u76ee\u9332" },
+    };
+    for (const auto& text : texts) {
+        std::string utf8;
+        std::wstring wide;
+        while (utf8.size() < size) {
+            utf8 += text.unit;
+            wide += text.wideUnit;
+        }
+        size_t sink = 0;
+        const double validateNs = nsPerCall(50, [&]() {
+            sink += app::arguments::validateUtf8(utf8) == app::arguments::UTF8_VALID;
+        });
+        const double memchrNs = nsPerCall(50, [&]() {
+            sink += std::memchr(utf8.data(), (sink & 1) != 0 ? '\n' : '\r', utf8.size()) == nullptr;
+        });
+        const wchar_t* wideArgv[]{ L"bench", wide.c_str() };
+        app::config::WideArguments converter;
+        const double wideNs = nsPerCall(50, [&]() {
+            sink += converter.convert(2, wideArgv) == app::config::WideArguments::Result::Converted;
+        });
+        const auto mbs = [&utf8](double ns) {
+            return static_cast<double>(utf8.size()) / ns * 1000.0;
+        };
+        std::cout << std::setw(10) << text.name << std::fixed << std::setprecision(0) << std::setw(12) << mbs(validateNs)
+            << std::setw(12) << mbs(memchrNs) << std::setw(12) << mbs(wideNs) << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+        if (sink != 150) {
+            std::cout << "unexpected" << std::endl;
+        }
+    }
+}
+
+static void benchEnum()
+{
+    std::cout << "enumeration value conversion, ns per value" << std::endl;
+    std::cout << std::setw(10) << "names" << std::setw(12) << "hash" << std::setw(12) << "linear" << std::endl;
+    for (const size_t count : { 3, 16, 64 }) {
+        std::vector<std::string> names;
+        for (size_t i = 0; i < count; i++) {
+            names.push_back("value_" + std::to_string(i * 7919 % 1000));
+        }
+        app::arguments::Options hashed('e', "enum", "an enumeration", app::arguments::Type::Mandatory, names);
+        app::arguments::Options linear = hashed;
+        hashed.enumIndex.build(hashed.enumNames);
+        const size_t iterations = 1000000;
+        size_t sink = 0;
+        size_t next = 0;
+        const auto convert = [&](const app::arguments::Options& opt) {
+            return nsPerCall(iterations, [&]() {
+                sink += std::get<int32_t>(opt.acquireValue(names[next].c_str()));
+                next = next + 1 < count ? next + 1 : 0;
+            });
+        };
+        const double hashNs = convert(hashed);
+        const double linearNs = convert(linear);
+        std::cout << std::setw(10) << count << std::fixed << std::setprecision(1) << std::setw(12) << hashNs
+            << std::setw(12) << linearNs << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+        for (size_t i = 0; i < count; i++) {
+            if (hashed.findEnum(names[i]) != static_cast<int32_t>(i) || linear.findEnum(names[i]) != static_cast<int32_t>(i)) {
+                std::cout << "unexpected" << std::endl;
+            }
+        }
+        if (sink == 0) {
+            std::cout << "unexpected" << std::endl;
+        }
+    }
+    app::arguments::Options plain('n', "number", "a number", app::arguments::Type::Mandatory, app::arguments::ValueType::Int32);
+    app::arguments::Options bounded = plain;
+    bounded.minValue = int32_t(0);
+    bounded.maxValue = int32_t(1000);
+    int64_t sink = 0;
+    const auto convert = [&sink](const app::arguments::Options& opt) {
+        return nsPerCall(1000000, [&]() {
+            sink += std::get<int32_t>(opt.acquireValue("742"));
+        });
+    };
+    const double plainNs = convert(plain);
+    const double boundedNs = convert(bounded);
+    std::cout << "int32 conversion " << std::fixed << std::setprecision(1) << plainNs << " ns, with range check "
+        << boundedNs << " ns" << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+    if (sink == 0) {
+        std::cout << "unexpected" << std::endl;
+    }
+}
+
+static void benchErrors()
+{
+    std::cout << "error-heavy input, ns per parse: the exception-free parse against the same values converted with throwing acquireValue()" << std::endl;
+    std::cout << std::setw(14) << "input" << std::setw(12) << "parse" << std::setw(12) << "throwing" << std::endl;
+    std::vector<app::arguments::Options> optMap;
+    for (int i = 0; i < 8; i++) {
+        optMap.emplace_back(static_cast<char>('a' + i), "int_" + std::to_string(i), "an integer", app::arguments::Type::Optional,
+            app::arguments::ValueType::Int32);
+    }
+    optMap.emplace_back('m', "mandatory", "a bounded integer", app::arguments::Type::Mandatory, app::arguments::ValueType::Int32);
+    optMap.back().minValue = int32_t(0);
+    optMap.back().maxValue = int32_t(100);
+    const app::arguments::ParserSchema schema(optMap);
+    const struct {
+        const char* name;
+        std::vector<const char*> args;
+    } inputs[] = {
+        { "valid", { "bench", "-a", "1", "-b", "2", "-c", "3", "-d", "4", "-e", "5", "-f", "6", "-g", "7", "-h", "8", "-m", "9" } },
+        { "typo", { "bench", "-a", "1", "--int_9", "2" } },
+        { "bad optional", { "bench", "-a", "x1", "-b", "x2", "-c", "x3", "-d", "x4", "-e", "x5", "-f", "x6", "-g", "x7", "-h", "x8", "-m", "9" } },
+        { "bad mandatory", { "bench", "-m", "nine" } },
+        { "out of range", { "bench", "-m", "900" } },
+    };
+    app::config::ParseContext ctx;
+    const size_t iterations = 100000;
+    size_t sink = 0;
+    for (const auto& input : inputs) {
+        const int argc = static_cast<int>(input.args.size());
+        char** argv = const_cast<char**>(input.args.data());
+        const double parseNs = nsPerCall(iterations, [&]() {
+            sink += ctx.tryParseArgs(argc, argv, schema).has_value();
+        });
+        // the values the parse converts, each bad one throws and is caught
+        const double throwingNs = !APP_EXCEPTIONS ? 0.0 : nsPerCall(iterations, [&]() {
+            for (int i = 1; i + 1 < argc; i += 2) {
+                const size_t idx = schema.findShort(argv[i][1]);
+                if (idx == app::arguments::ParserSchema::npos) {
+                    break;
+                }
+                try {
+                    sink += schema[idx].acquireValue(argv[i + 1]).index();
+                } catch (const std::invalid_argument&) {
+                    sink ++;
+                    if (schema[idx].type == app::arguments::Type::Mandatory) {
+                        break;
+                    }
+                }
+            }
+        });
+        std::cout << std::setw(14) << input.name << std::fixed << std::setprecision(0) << std::setw(12) << parseNs << std::setw(12);
+        if (APP_EXCEPTIONS) {
+            std::cout << throwingNs << std::endl;
+        }
+        else {
+            std::cout << "-" << std::endl; // the library is built without exceptions
+        }
+        std::cout.unsetf(std::ios::fixed);
+    }
+    if (sink == 0) {
+        std::cout << "unexpected" << std::endl;
+    }
+}
+
+struct Benchmark {
+    const char* name;
+    void (*run)();
+};
+
+static const Benchmark benchmarks[] = {
+    { "schema", benchSchema },
+    { "numeric", benchNumeric },
+    { "threads", benchThreads },
+    { "parse", benchParse },
+    { "helpers", benchHelpers },
+    { "file", benchConfigFile },
+    { "response", benchResponseFile },
+    { "batch", benchBatch },
+    { "snapshot", benchSnapshot },
+    { "stats", benchStats },
+    { "arena", benchArena },
+    { "lazy", benchLazy },
+    { "prefix", benchPrefix },
+    { "list", benchList },
+    { "env", benchEnvironment },
+    { "live", benchLive },
+    { "inline", benchInlineValues },
+    { "utf8", benchUtf8 },
+    { "stream", benchStream },
+    { "command", benchCommandString },
+    { "subcommands", benchSubcommands },
+    { "enum", benchEnum },
+    { "errors", benchErrors },
+};
+
+int main(int argc, char* argv[])
+{
+    for (const auto& b : benchmarks) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc && !selected; i++) {
+            selected = strcmp(argv[i], b.name) == 0;
+        }
+        if (selected) {
+            b.run();
+        }
+    }
+    return EXIT_SUCCESS;
+}
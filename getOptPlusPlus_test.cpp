@@ -3,9 +3,24 @@
 
 #include "getOptPlusPlus.h"
 #include "appConfig.h"
+#include "appStaticSchema.h"
+#include "appResponseFile.h"
+#include "appBatch.h"
+#include "appSnapshot.h"
+#include "appStats.h"
+#include "appLiveConfig.h"
+#include "appSubcommands.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <iostream>
+#include <memory_resource>
+#include <new>
 #include <iomanip>
+#include <filesystem>
+#include <fstream>
 #include <sstream>
+#include <thread>
 using namespace std;
 std::vector<app::arguments::Options> optMap = {
     app::arguments::Options('h', "help", "displays help usage message"),
@@ -15,6 +30,39 @@ std::vector<app::arguments::Options> optMap = {
     app::arguments::Options('L', "log_dir","A directory to store program logs", app::arguments::Type::Mandatory, app::arguments::ValueType::String, app::arguments::DefaultValue(".")),
     app::arguments::Options('P', "probability", "Probability to match file", app::arguments::Type::Mandatory, app::arguments::ValueType::Float, app::arguments::DefaultValue(0.5)),
 };
+inline constexpr app::arguments::StaticOption staticOptMap[] = {
+    app::arguments::StaticOption('h', "help", "displays help usage message"),
+    app::arguments::StaticOption('O', "output_directory", "a directory where received files are stored", app::arguments::Type::Mandatory, app::arguments::ValueType::String),
+    app::arguments::StaticOption('D', "dark_color", "a color to detect dark images", app::arguments::Type::Mandatory, app::arguments::ValueType::Int32h, int32_t(0x090909)),
+    app::arguments::StaticOption('I', "id", "an id for something", app::arguments::Type::Optional, app::arguments::ValueType::Int64, int64_t(0x100)),
+    app::arguments::StaticOption('L', "log_dir","A directory to store program logs", app::arguments::Type::Mandatory, app::arguments::ValueType::String, "."),
+    app::arguments::StaticOption('P', "probability", "Probability to match file", app::arguments::Type::Mandatory, app::arguments::ValueType::Float, 0.5),
+};
+typedef app::arguments::StaticSchema<staticOptMap> StaticOpts;
+static std::atomic<bool> failAllocations(false); // global operator new throws while set
+
+void* operator new(std::size_t size)
+{
+    if (failAllocations.load(std::memory_order_relaxed)) {
+        throw std::bad_alloc();
+    }
+    void* p = std::malloc(size != 0 ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
 constexpr const int EXIT_HELP = EXIT_FAILURE + 1;
 constexpr const int EXIT_MANDATORY = EXIT_FAILURE + 2;
 constexpr const int EXIT_ABSENT = EXIT_FAILURE + 3;
@@ -44,17 +92,20 @@ static std::ostream& printValue(app::arguments::Value val, std::ostream& os)
             os << "false";
         }
         break;
+    case 5: // borrowed string
+        os << std::get<app::arguments::BorrowedString>(val);
+        break;
     default:
         os << "unknown value type";
     }
     return os;
 }
 
-static int testSet(int argc, char* argv[], bool bPrintUsage = false)
+static int testSet(int argc, char* argv[], bool bPrintUsage = false, const app::arguments::ParserSchema* pSchema = nullptr)
 {
     app::config::Config& cfg = app::config::Config::getInstance();
     int nRet = EXIT_SUCCESS;
-    const app::config::ParseResult res = cfg.parseArgs(argc, argv, optMap);
+    const app::config::ParseResult res = pSchema != nullptr ? cfg.parseArgs(argc, argv, *pSchema) : cfg.parseArgs(argc, argv, optMap);
     bool bHelpRequired = false;
     switch (res) {
     case app::config::ParseResult::Parsed:
@@ -79,6 +130,15 @@ static int testSet(int argc, char* argv[], bool bPrintUsage = false)
         bHelpRequired = true;
         nRet = EXIT_FAILURE;
         break;
+    case app::config::ParseResult::Ambiguous:
+        std::cerr << "ambiguous option abbreviation. Error in argument at index " << cfg.badArgumentIndex << std::endl;
+        bHelpRequired = true;
+        nRet = EXIT_FAILURE;
+        break;
+    case app::config::ParseResult::BadEncoding:
+        std::cerr << "invalid character. Error in argument at index " << cfg.badArgumentIndex << " (offset in argument " << cfg.badArgumentOffset << ")" << std::endl;
+        nRet = EXIT_FAILURE;
+        break;
     case app::config::ParseResult::None:
     default:
         bHelpRequired = true;
@@ -150,6 +210,12 @@ const char* testSet5[]{ "program1", "-D", "505050", "-O", "."};
 const char* testSet6[]{ "program1", "-D", "505050", "-O", ".", "-I","1"};
 const char* testSet7[]{ "program1", "-D", "505050", "-O", ".", "-P","0"};
 const char* testSet8[]{ "program1", "-D", "505050", "-O", ".", "-P","0.7"};
+const char* testSet111[]{ "program1", "-D", "1ffffffff", "-O", ".", "-P","0.7"};
+const char* testSet112[]{ "program1", "-D", "505050", "-O", ".", "-P","0.7x"};
+const char* testSet113[]{ "program1", "-D", "0x50zz", "-O", ".", "-P","0.7"};
+const char* testSet114[]{ "program1", "-D", "0x-1f", "-O", ".", "-P","0.7"};
+const char* testSet115[]{ "program1", "-D", "+-5", "-O", ".", "-P","0.7"};
+const char* testSet116[]{ "program1", "-D", "505050", "-O", ".", "-P","+-0.7"};
 std::map<int, std::string> stringTable = {
     {EXIT_SUCCESS, "EXIT_SUCCESS"},
     {EXIT_FAILURE, "EXIT_FAILURE"},
@@ -271,6 +337,1238 @@ int performAllTests()
         std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
         return EXIT_FAILURE;
     }
+    testNum = 9;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    const app::arguments::ParserSchema schema(optMap);
+    nRet = testSet(7, (char**)testSet8, false, &schema);
+    if (nRet == expected) {
+        nRet = testSet(2, (char**)testSet32, false, &schema);
+        expected = EXIT_HELP;
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 10;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    nRet = testSet(7, (char**)testSet8, false, &StaticOpts::schema());
+    if (nRet == expected) {
+        app::config::Config& cfg = app::config::Config::getInstance();
+        const int32_t color = cfg.get<StaticOpts, StaticOpts::index("dark_color")>();
+        const double probability = cfg.get<StaticOpts, StaticOpts::index("probability")>();
+        const std::string_view logDir = cfg.get<StaticOpts, StaticOpts::index("log_dir")>();
+        if (color != 0x505050 || probability != 0.7 || logDir != ".") {
+            nRet = EXIT_DIFF_TYPE;
+        }
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 11;
+    expected = EXIT_FAILURE;
+    std::cout << "Performing test " << testNum << std::endl;
+    for (const char** pSet : { testSet111, testSet112, testSet113, testSet114, testSet115, testSet116 }) {
+        nRet = testSet(7, (char**)pSet);
+        if (nRet != expected) {
+            break;
+        }
+    }
+    {
+        // a sign before the "0x" prefix is accepted, a sign after it is not
+        int32_t hex = 0;
+        int64_t hex64 = 0;
+        if (nRet == expected && (app::arguments::toInteger("-0x1f", 16, hex) != app::arguments::ConvResult::Ok || hex != -31 ||
+            app::arguments::toInteger("-0x80000000", 16, hex) != app::arguments::ConvResult::Ok || hex != INT32_MIN ||
+            app::arguments::toInteger("-0x80000001", 16, hex) != app::arguments::ConvResult::Overflow ||
+            app::arguments::toInteger("-0x8000000000000000", 16, hex64) != app::arguments::ConvResult::Ok || hex64 != INT64_MIN ||
+            app::arguments::toInteger("-0x-1f", 16, hex) != app::arguments::ConvResult::Invalid ||
+            app::arguments::toInteger("0x-1f", 16, hex) != app::arguments::ConvResult::Invalid ||
+            app::arguments::toInteger("-1f", 16, hex) != app::arguments::ConvResult::Ok || hex != -31)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 12;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        app::config::Config& cfg = app::config::Config::getInstance();
+        cfg.setStringMode(app::arguments::StringMode::Borrow);
+        nRet = cfg.parseArgs(7, (char**)testSet8, schema) == app::config::ParseResult::Parsed ? EXIT_SUCCESS : EXIT_FAILURE;
+        if (nRet == EXIT_SUCCESS) {
+            // string values must point into argv and into the schema defaults
+            if (cfg.getString("output_directory").data() != testSet8[4] ||
+                cfg.getString("log_dir").data() != std::get<std::string>(schema[4].defaultValue.value()).data() ||
+                cfg.valid(schema.options()) != app::config::Config::MANDATORY_PASSED_ALL) {
+                nRet = EXIT_DIFF_TYPE;
+            }
+        }
+        cfg.setStringMode(app::arguments::StringMode::Copy);
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 13;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // independent contexts parse different command lines concurrently
+        std::vector<std::thread> threads;
+        std::vector<int> results(4, EXIT_SUCCESS);
+        for (size_t t = 0; t < results.size(); t++) {
+            threads.emplace_back([t, &schema, &results]() {
+                app::config::ParseContext ctx;
+                for (int i = 0; i < 1000 && results[t] == EXIT_SUCCESS; i++) {
+                    const bool bHelp = (t + i) % 2 != 0;
+                    if (bHelp) {
+                        if (ctx.parseArgs(2, (char**)testSet32, schema) != app::config::ParseResult::Parsed || !ctx.hasValue("help")) {
+                            results[t] = EXIT_FAILURE;
+                        }
+                    }
+                    else if (ctx.parseArgs(7, (char**)testSet8, schema) != app::config::ParseResult::Parsed ||
+                             ctx.hasValue("help") || std::get<double>(ctx.getValueRef("probability")) != 0.7) {
+                        results[t] = EXIT_FAILURE;
+                    }
+                }
+            });
+        }
+        for (auto& th : threads) {
+            th.join();
+        }
+        for (int res : results) {
+            if (res != EXIT_SUCCESS) {
+                nRet = res;
+            }
+        }
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 14;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // option handles are resolved once and read values without name lookup
+        const auto hProbability = schema.handle("probability");
+        const auto hOutput = schema.handle("output_directory");
+        const auto hId = schema.handle("id");
+        app::config::ParseContext ctx;
+        nRet = EXIT_SUCCESS;
+        if (ctx.parseArgs(3, (char**)testSet42, schema) != app::config::ParseResult::Parsed || ctx.hasValue(hOutput) ||
+            ctx.valid() != hOutput.index) {
+            nRet = EXIT_MANDATORY;
+        }
+        else if (ctx.parseArgs(7, (char**)testSet6, schema) != app::config::ParseResult::Parsed ||
+                 ctx.valid() != app::config::ParseContext::MANDATORY_PASSED_ALL ||
+                 std::get<double>(ctx.getValue(hProbability)) != 0.5 || ctx.find(hId) == nullptr ||
+                 std::get<int64_t>(*ctx.find(hId)) != 1) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 15;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // command line values override configuration file values
+        const std::string path = (std::filesystem::temp_directory_path() / "getOptPlusPlus_test.conf").string();
+        {
+            std::ofstream conf(path);
+            conf << "# test configuration" << std::endl << std::endl
+                << "output_directory = \"/var/spool/in \"" << std::endl
+                << "  dark_color=0x101010\r" << std::endl
+                << "id = 42" << std::endl
+                << "probability = 0.25";
+        }
+        app::config::ConfigFile file;
+        app::config::ParseContext ctx;
+        nRet = EXIT_FAILURE;
+        if (file.load(path) && ctx.parseArgs(5, (char**)testSet5, schema, file) == app::config::ParseResult::Parsed) {
+            nRet = EXIT_SUCCESS;
+            if (ctx.getString("output_directory") != "." || std::get<int32_t>(ctx.getValue("dark_color")) != 0x505050 ||
+                std::get<int64_t>(ctx.getValue("id")) != 42 || std::get<double>(ctx.getValue("probability")) != 0.25) {
+                nRet = EXIT_DIFF_TYPE;
+            }
+            ctx.reset(schema);
+            if (ctx.merge(file) != app::config::ParseResult::Parsed || ctx.getString("output_directory") != "/var/spool/in " ||
+                std::get<int32_t>(ctx.getValue("dark_color")) != 0x101010) {
+                nRet = EXIT_DIFF_TYPE;
+            }
+        }
+        {
+            std::ofstream conf(path);
+            conf << "id = 1" << std::endl << "colour = 0x101010" << std::endl;
+        }
+        if (nRet == EXIT_SUCCESS && (!file.load(path) || ctx.parseArgs(1, (char**)testSet1, schema, file) != app::config::ParseResult::BadOptionIndex ||
+            ctx.badArgumentIndex != 2)) {
+            nRet = EXIT_FAILURE;
+        }
+        std::filesystem::remove(path);
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 16;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // nested response files are expanded in place, recursion is detected
+        const auto dir = std::filesystem::temp_directory_path();
+        const std::string outer = (dir / "getOptPlusPlus_test_outer.rsp").string();
+        const std::string inner = (dir / "getOptPlusPlus_test_inner.rsp").string();
+        {
+            std::ofstream rsp(outer);
+            rsp << "-D 505050\n@" << inner << "\n";
+        }
+        {
+            std::ofstream rsp(inner);
+            rsp << "  -O \"/tmp/with space\" -P\t'0.7'";
+        }
+        std::string arg = "@" + outer;
+        const char* rspSet[]{ "program1", arg.c_str(), "-I", "7" };
+        app::config::ResponseFiles rsp;
+        app::config::ParseContext ctx;
+        nRet = EXIT_FAILURE;
+        if (rsp.expand(4, (char**)rspSet) == app::config::ResponseFiles::Result::Expanded && rsp.argc() == 9 &&
+            rsp.argv()[9] == nullptr && ctx.parseArgs(rsp.argc(), rsp.argv(), schema) == app::config::ParseResult::Parsed) {
+            nRet = EXIT_SUCCESS;
+            if (ctx.getString("output_directory") != "/tmp/with space" || std::get<double>(ctx.getValue("probability")) != 0.7 ||
+                std::get<int64_t>(ctx.getValue("id")) != 7) {
+                nRet = EXIT_DIFF_TYPE;
+            }
+        }
+        {
+            std::ofstream rsp(inner);
+            rsp << "-h @" << outer;
+        }
+        if (nRet == EXIT_SUCCESS && (rsp.expand(4, (char**)rspSet) != app::config::ResponseFiles::Result::Recursion || rsp.badArgumentIndex != 1)) {
+            nRet = EXIT_FAILURE;
+        }
+        std::filesystem::remove(outer);
+        std::filesystem::remove(inner);
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 17;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // batch of command lines is parsed into per-line results and per-option columns
+        const char* batchSet1[]{ "program1", "-O", "/tmp/a", "-I", "1" };
+        const char* batchSet2[]{ "program1", "-O", "/tmp/b", "-P", "0.25" };
+        const char* batchSet3[]{ "program1", "-X" };
+        std::vector<app::config::ArgvSet> sets;
+        for (int i = 0; i < 1000; i++) {
+            switch (i % 3) {
+                case 0: sets.push_back({ 5, (char**)batchSet1 }); break;
+                case 1: sets.push_back({ 5, (char**)batchSet2 }); break;
+                default: sets.push_back({ 2, (char**)batchSet3 }); break;
+            }
+        }
+        app::config::BatchParser batch(schema, 4);
+        app::config::BatchResult result;
+        batch.parse(sets.data(), sets.size(), result);
+        const auto out = schema.handle("output_directory");
+        const auto prob = schema.handle("probability");
+        nRet = EXIT_SUCCESS;
+        if (result.size() != sets.size() || result.column(out).lines.size() != 667 || result.column(prob).lines.size() != 333) {
+            nRet = EXIT_FAILURE;
+        }
+        for (size_t line = 0; nRet == EXIT_SUCCESS && line < result.size(); line++) {
+            const app::arguments::Value* pProb = result.find(prob, line);
+            switch (line % 3) {
+                case 0:
+                    if (result.result(line) != app::config::ParseResult::Parsed || pProb == nullptr || std::get<double>(*pProb) != 0.5 ||
+                        result.find(schema.handle("id"), line) == nullptr) {
+                        nRet = EXIT_DIFF_TYPE;
+                    }
+                    break;
+                case 1:
+                    if (result.result(line) != app::config::ParseResult::Parsed || pProb == nullptr || std::get<double>(*pProb) != 0.25 ||
+                        result.find(schema.handle("id"), line) != nullptr) {
+                        nRet = EXIT_DIFF_TYPE;
+                    }
+                    break;
+                default:
+                    if (result.result(line) != app::config::ParseResult::Unknown || result.badArgumentIndex(line) != 1 ||
+                        result.badArgumentOffset(line) != 1) {
+                        nRet = EXIT_FAILURE;
+                    }
+                    break;
+            }
+        }
+        // a line failing after some options were parsed contributes no cells
+        const char* batchSet4[]{ "program1", "-O", "/tmp/c", "-I", "2", "-X" };
+        const app::config::ArgvSet badSets[]{ { 6, (char**)batchSet4 }, { 5, (char**)batchSet1 } };
+        batch.parse(badSets, 2, result);
+        if (nRet == EXIT_SUCCESS && (result.result(0) != app::config::ParseResult::Unknown || result.badArgumentIndex(0) != 5 ||
+            result.find(out, 0) != nullptr || result.find(schema.handle("id"), 0) != nullptr ||
+            result.column(out).lines.size() != 1 || result.find(out, 1) == nullptr)) {
+            nRet = EXIT_FAILURE;
+        }
+        const std::string path = (std::filesystem::temp_directory_path() / "getOptPlusPlus_test_batch.txt").string();
+        {
+            std::ofstream lines(path);
+            lines << "program1 -O \"/tmp/with space\" -D 101010\n\nprogram1 -O '/tmp/x\nprogram1 -P 0.1";
+        }
+        if (nRet == EXIT_SUCCESS && (!batch.parseFile(path, result) || result.size() != 4 ||
+            result.result(0) != app::config::ParseResult::Parsed || result.result(2) != app::config::ParseResult::Error ||
+            result.badArgumentIndex(2) != 2 || result.result(3) != app::config::ParseResult::Parsed ||
+            result.column(out).lines.size() != 1 || result.find(out, 0) == nullptr ||
+            std::get<app::arguments::BorrowedString>(*result.find(out, 0)) != "/tmp/with space" ||
+            std::get<int32_t>(*result.find(schema.handle("dark_color"), 0)) != 0x101010)) {
+            nRet = EXIT_FAILURE;
+        }
+        std::filesystem::remove(path);
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 18;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // parsed values are restored from the snapshot only when the inputs match
+        const std::string path = (std::filesystem::temp_directory_path() / "getOptPlusPlus_test.snapshot").string();
+        const char* snapSet[]{ "program1", "-O", "/tmp/snap", "-I", "77", "-P", "0.125" };
+        const char* otherSet[]{ "program1", "-O", "/tmp/other" };
+        app::config::ParseContext parsed;
+        const uint64_t key = app::config::Snapshot::makeKey(schema, parsed, 7, (char**)snapSet);
+        app::config::ParseContext restored;
+        app::config::Snapshot snapshot;
+        std::filesystem::remove(path);
+        nRet = EXIT_FAILURE;
+        if (key != app::config::Snapshot::makeKey(schema, parsed, 3, (char**)otherSet) && !snapshot.load(path, key, schema, restored) &&
+            parsed.parseArgs(7, (char**)snapSet, schema) == app::config::ParseResult::Parsed &&
+            app::config::Snapshot::save(path, key, parsed) && snapshot.load(path, key, schema, restored)) {
+            nRet = EXIT_SUCCESS;
+            if (restored.getString("output_directory") != "/tmp/snap" || std::get<int64_t>(restored.getValue("id")) != 77 ||
+                std::get<double>(restored.getValue("probability")) != 0.125 || restored.getString("log_dir") != "." ||
+                std::get<int32_t>(restored.getValue("dark_color")) != 0x090909 || restored.hasValue("help") ||
+                restored.assignedMask() != parsed.assignedMask() || restored.valid() != app::config::ParseContext::MANDATORY_PASSED_ALL) {
+                nRet = EXIT_DIFF_TYPE;
+            }
+        }
+        if (nRet == EXIT_SUCCESS && snapshot.load(path, app::config::Snapshot::makeKey(schema, parsed, 3, (char**)otherSet), schema, restored)) {
+            nRet = EXIT_FAILURE;
+        }
+        // parse settings changing the results change the key
+        app::config::ParseContext abbreviated;
+        abbreviated.setAbbreviations(true);
+        app::config::ParseContext validated;
+        validated.setUtf8Validation(true);
+        if (nRet == EXIT_SUCCESS && (app::config::Snapshot::makeKey(schema, abbreviated, 7, (char**)snapSet) == key ||
+            app::config::Snapshot::makeKey(schema, validated, 7, (char**)snapSet) == key)) {
+            nRet = EXIT_FAILURE;
+        }
+        // a record of an unknown value kind rejects the snapshot
+        {
+            std::ifstream in(path, std::ios::binary);
+            std::string image((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            const size_t headerSize = 32;
+            const size_t recordSize = 16;
+            for (size_t i = 0; i < schema.size(); i++) {
+                if ((image[headerSize + i * recordSize] & 1) != 0) {
+                    image[headerSize + i * recordSize + 1] = 0x7f; // the first present record
+                    break;
+                }
+            }
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out << image;
+        }
+        if (nRet == EXIT_SUCCESS && snapshot.load(path, key, schema, restored)) {
+            nRet = EXIT_FAILURE;
+        }
+        // a string offset past the blob and a list size not multiple of its elements reject the snapshot
+        for (const int corruption : { 0, 1 }) {
+            if (nRet != EXIT_SUCCESS || !app::config::Snapshot::save(path, key, parsed)) {
+                nRet = EXIT_FAILURE;
+                break;
+            }
+            std::ifstream in(path, std::ios::binary);
+            std::string image((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            in.close();
+            const size_t headerSize = 32;
+            const size_t recordSize = 16;
+            for (size_t i = 0; i < schema.size(); i++) {
+                char* const pRecord = image.data() + headerSize + i * recordSize;
+                if ((pRecord[0] & 1) != 0 && pRecord[1] == 0) { // the first present string
+                    if (corruption == 0) {
+                        const uint64_t payload = UINT64_MAX;
+                        std::memcpy(pRecord + 8, &payload, sizeof(payload));
+                    }
+                    else {
+                        pRecord[1] = 6; // "/tmp/snap" as a 32-bit integer list
+                    }
+                    break;
+                }
+            }
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out << image;
+            out.close();
+            if (snapshot.load(path, key, schema, restored)) {
+                nRet = EXIT_FAILURE;
+            }
+        }
+        // configuration file changes invalidate the key
+        const std::string confPath = (std::filesystem::temp_directory_path() / "getOptPlusPlus_test_snapshot.conf").string();
+        {
+            std::ofstream conf(confPath);
+            conf << "id = 1" << std::endl;
+        }
+        const uint64_t confKey = app::config::Snapshot::makeKey(schema, parsed, 7, (char**)snapSet, confPath);
+        {
+            std::ofstream conf(confPath);
+            conf << "id = 12" << std::endl;
+        }
+        if (nRet == EXIT_SUCCESS && (confKey == key || confKey == app::config::Snapshot::makeKey(schema, parsed, 7, (char**)snapSet, confPath))) {
+            nRet = EXIT_FAILURE;
+        }
+        std::filesystem::remove(confPath);
+        std::filesystem::remove(path);
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 19;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // instrumentation counts phases, conversions and exceptions only when it is compiled in, a failed conversion throws nothing
+        const char* statsSet[]{ "program1", "-O", "/tmp/stats", "-I", "abc", "-P", "0.5" };
+        auto& stats = app::config::ParseStats::current();
+        stats.reset();
+        app::config::ParseContext ctx;
+        nRet = EXIT_FAILURE;
+        if (ctx.parseArgs(7, (char**)statsSet, schema) == app::config::ParseResult::Parsed &&
+            ctx.valid() == app::config::ParseContext::MANDATORY_PASSED_ALL) {
+            nRet = EXIT_SUCCESS;
+            const std::string json = stats.toJson();
+            if (app::config::ParseStats::enabled) {
+                if (stats.phaseCalls[app::config::ParseStats::Tokenize] != 1 || stats.phaseCalls[app::config::ParseStats::Validation] != 1 ||
+                    stats.phaseCalls[app::config::ParseStats::Conversion] != 3 ||
+                    stats.conversions[static_cast<size_t>(app::arguments::ValueType::Int64)] != 1 ||
+                    stats.conversions[static_cast<size_t>(app::arguments::ValueType::String)] != 1 || stats.conversionFailures != 1 ||
+                    stats.exceptionsThrown != 0 || json.find("\"tokenize\":{\"ns\":") == std::string::npos) {
+                    nRet = EXIT_DIFF_TYPE;
+                }
+            }
+            else if (stats.phaseCalls[app::config::ParseStats::Tokenize] != 0 || stats.exceptionsThrown != 0 ||
+                json.find("\"enabled\":false") == std::string::npos) {
+                nRet = EXIT_DIFF_TYPE;
+            }
+        }
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 20;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // a parse backed by a stack buffer makes no global heap allocations
+        const char* arenaSet[]{ "program1", "-O", "/var/spool/a/rather/long/directory", "-I", "4660", "-P", "0.75", "-h" };
+        char buf[2048];
+        std::pmr::monotonic_buffer_resource arena(buf, sizeof(buf), std::pmr::null_memory_resource());
+        app::config::ParseContext ctx(&arena);
+        ctx.setStringMode(app::arguments::StringMode::Arena);
+        app::config::ParseContext copyCtx;
+        copyCtx.parseArgs(1, (char**)arenaSet, schema);
+        app::config::ParseResult res = app::config::ParseResult::None;
+        bool bCopyFailed = false;
+        failAllocations = true;
+        try {
+            res = ctx.parseArgs(8, (char**)arenaSet, schema);
+            copyCtx.parseArgs(8, (char**)arenaSet, schema); // copies the long string with operator new
+        } catch (const std::bad_alloc&) {
+            bCopyFailed = true;
+        }
+        failAllocations = false;
+        nRet = EXIT_FAILURE;
+        if (res == app::config::ParseResult::Parsed && bCopyFailed) {
+            nRet = EXIT_SUCCESS;
+            std::string_view dir = ctx.getString("output_directory");
+            if (dir != "/var/spool/a/rather/long/directory" || dir.data() == arenaSet[2] ||
+                dir.data() < buf || dir.data() >= buf + sizeof(buf) || std::get<int64_t>(ctx.getValue("id")) != 4660 ||
+                ctx.getString("log_dir") != "." || !ctx.hasValue("help") || ctx.valid() != app::config::ParseContext::MANDATORY_PASSED_ALL) {
+                nRet = EXIT_DIFF_TYPE;
+            }
+        }
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 21;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // lazy values are converted on the first access, conversion errors are reported on access
+        const char* lazySet[]{ "program1", "-O", "/tmp/lazy", "-I", "abc", "-D", "zz", "-P", "0.25" };
+        app::config::ParseContext ctx;
+        ctx.setLazy(true);
+        nRet = EXIT_FAILURE;
+        if (ctx.parseArgs(9, (char**)lazySet, schema) == app::config::ParseResult::Parsed && ctx.hasValue("dark_color") &&
+            ctx.valid() == app::config::ParseContext::MANDATORY_PASSED_ALL) {
+            nRet = EXIT_SUCCESS;
+            std::atomic<int> bad(0);
+            std::vector<std::thread> readers;
+            for (int t = 0; t < 4; t++) {
+                readers.emplace_back([&]() {
+                    try {
+                        if (ctx.getString("output_directory") != "/tmp/lazy" || !std::get<bool>(ctx.getValue("id")) ||
+                            std::get<double>(ctx.getValue("probability")) != 0.25) {
+                            bad ++;
+                        }
+                    } catch (const std::exception&) {
+                        bad ++;
+                    }
+                });
+            }
+            for (auto& th : readers) {
+                th.join();
+            }
+            bool bThrown = false;
+            try {
+                static_cast<void>(ctx.getValue("dark_color"));
+            } catch (const std::invalid_argument&) {
+                bThrown = true;
+            }
+            if (bad != 0 || !bThrown || ctx.find(schema.handle("dark_color")) != nullptr || ctx.validateAll() != 2) {
+                nRet = EXIT_DIFF_TYPE;
+            }
+        }
+        lazySet[6] = "0x0a0b0c";
+        if (nRet == EXIT_SUCCESS && (ctx.parseArgs(9, (char**)lazySet, schema) != app::config::ParseResult::Parsed ||
+            ctx.validateAll() != app::config::ParseContext::MANDATORY_PASSED_ALL ||
+            ctx.get<StaticOpts, StaticOpts::index("dark_color")>() != 0x0a0b0c)) {
+            nRet = EXIT_FAILURE;
+        }
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 22;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // unique prefixes and getopt_long_only single dash words
+        const app::arguments::ParserSchema verSchema(std::vector<app::arguments::Options>{
+            app::arguments::Options('h', "help", "displays help usage message"),
+            app::arguments::Options('v', "verbose", "verbose output"),
+            app::arguments::Options('V', "version", "prints version"),
+            app::arguments::Options(' ', "ver", "a version filter", app::arguments::Type::Optional, app::arguments::ValueType::String),
+            app::arguments::Options('l', "level", "verbosity level", app::arguments::Type::Optional, app::arguments::ValueType::Int32),
+        });
+        const char* prefixSet[]{ "program1", "--verb", "--vers", "--ver", "1.2", "--le", "3" };
+        const char* ambiguousSet[]{ "program1", "--verb", "--ve" };
+        const char* longOnlySet[]{ "program1", "-help", "-verb", "-l", "4", "-V" };
+        app::config::ParseContext ctx;
+        nRet = EXIT_FAILURE;
+        if (ctx.parseArgs(7, (char**)prefixSet, verSchema) == app::config::ParseResult::BadOptionIndex && ctx.badArgumentIndex == 1) {
+            ctx.setAbbreviations(true);
+            if (ctx.parseArgs(7, (char**)prefixSet, verSchema) == app::config::ParseResult::Parsed && ctx.hasValue("verbose") &&
+                ctx.hasValue("version") && ctx.getString("ver") == "1.2" && std::get<int32_t>(ctx.getValue("level")) == 3 &&
+                ctx.parseArgs(3, (char**)ambiguousSet, verSchema) == app::config::ParseResult::Ambiguous && ctx.badArgumentIndex == 2) {
+                nRet = EXIT_SUCCESS;
+            }
+        }
+        if (nRet == EXIT_SUCCESS && (ctx.parseArgs(6, (char**)longOnlySet, verSchema) != app::config::ParseResult::Unknown ||
+            ctx.badArgumentIndex != 1 || ctx.badArgumentOffset != 2)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+        ctx.setLongOnly(true);
+        if (nRet == EXIT_SUCCESS && (ctx.parseArgs(6, (char**)longOnlySet, verSchema) != app::config::ParseResult::Parsed ||
+            !ctx.hasValue("help") || !ctx.hasValue("verbose") || !ctx.hasValue("version") ||
+            std::get<int32_t>(ctx.getValue("level")) != 4)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 23;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // repeated list options append, comma separated values are split
+        const app::arguments::ParserSchema listSchema(std::vector<app::arguments::Options>{
+            app::arguments::Options('I', "include", "include directories", app::arguments::Type::Mandatory, app::arguments::ValueType::StringList),
+            app::arguments::Options('p', "port", "listen ports", app::arguments::Type::Mandatory, app::arguments::ValueType::Int64List),
+            app::arguments::Options('m', "mask", "hex masks", app::arguments::Type::Mandatory, app::arguments::ValueType::Int32hList),
+            app::arguments::Options('w', "weight", "weights", app::arguments::Type::Optional, app::arguments::ValueType::FloatList),
+        });
+        const char* listSet[]{ "program1", "-I", "/usr/include,/opt/include", "--include", "include", "-p", "80,443", "-p", "8080",
+            "-m", "ff,0x10", "-w", "0.5,1.5" };
+        const char* replaceSet[]{ "program1", "-p", "22" };
+        const char* badSet[]{ "program1", "-p", "80,http" };
+        const std::string path = (std::filesystem::temp_directory_path() / "getOptPlusPlus_list.snapshot").string();
+        app::config::ParseContext ctx;
+        app::config::ParseContext restored;
+        app::config::Snapshot snapshot;
+        nRet = EXIT_FAILURE;
+        if (ctx.parseArgs(13, (char**)listSet, listSchema) == app::config::ParseResult::Parsed) {
+            const auto& includes = std::get<app::arguments::StringList>(ctx.getValueRef("include"));
+            const auto& ports = std::get<std::vector<int64_t>>(ctx.getValueRef("port"));
+            const auto& masks = std::get<std::vector<int32_t>>(ctx.getValueRef("mask"));
+            const auto& weights = std::get<std::vector<double>>(ctx.getValueRef("weight"));
+            if (includes.size() == 3 && includes[0] == "/usr/include" && std::strcmp(includes.c_str(1), "/opt/include") == 0 &&
+                includes[2] == "include" && ports == std::vector<int64_t>{ 80, 443, 8080 } && masks == std::vector<int32_t>{ 0xff, 0x10 } &&
+                weights == std::vector<double>{ 0.5, 1.5 }) {
+                nRet = EXIT_SUCCESS;
+            }
+        }
+        const uint64_t key = app::config::Snapshot::makeKey(listSchema, ctx, 13, (char**)listSet);
+        std::filesystem::remove(path);
+        if (nRet == EXIT_SUCCESS && (!app::config::Snapshot::save(path, key, ctx) || !snapshot.load(path, key, listSchema, restored) ||
+            restored.getValueRef("include") != ctx.getValueRef("include") || restored.getValueRef("port") != ctx.getValueRef("port") ||
+            restored.getValueRef("weight") != ctx.getValueRef("weight"))) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+        std::filesystem::remove(path);
+        // a later merge call replaces the list
+        if (nRet == EXIT_SUCCESS && (ctx.mergeArgs(3, (char**)replaceSet) != app::config::ParseResult::Parsed ||
+            std::get<std::vector<int64_t>>(ctx.getValueRef("port")) != std::vector<int64_t>{ 22 })) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+        if (nRet == EXIT_SUCCESS && (ctx.parseArgs(3, (char**)badSet, listSchema) != app::config::ParseResult::Error || ctx.badArgumentIndex != 2)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 24;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // command line values override environment values, environment values override defaults
+        std::vector<app::arguments::Options> envOpts{
+            app::arguments::Options('O', "output-dir", "output directory", app::arguments::Type::Mandatory, app::arguments::ValueType::String),
+            app::arguments::Options('l', "level", "verbosity level", app::arguments::Type::Mandatory, app::arguments::ValueType::Int32, 1),
+            app::arguments::Options('t', "threads", "worker threads", app::arguments::Type::Mandatory, app::arguments::ValueType::Int32, 4),
+            app::arguments::Options('v', "verbose", "verbose output"),
+            app::arguments::Options('p', "port", "listen ports", app::arguments::Type::Mandatory, app::arguments::ValueType::Int32List),
+        };
+        envOpts[1].envName = "LOG_LEVEL";
+        app::arguments::mapEnvironment(envOpts, "GOPT_");
+        const app::arguments::ParserSchema envSchema(envOpts);
+        const char* envSet[]{ "PATH=/bin", "GOPT_OUTPUT_DIR=/env", "GOPT_VERBOSE=1", "GOPT_LEVEL=9", "LOG_LEVEL=5",
+            "GOPT_PORT=80,443", "GOPT_UNKNOWN=1", "GOPT", nullptr };
+        const char* badEnvSet[]{ "HOME=/root", "GOPT_THREADS=many", nullptr };
+        const char* argSet[]{ "program1", "-O", "/cli" };
+        app::config::ParseContext ctx;
+        nRet = EXIT_FAILURE;
+        if (envSchema.findEnv("GOPT_OUTPUT_DIR") == 0 && envSchema.findEnv("LOG_LEVEL") == 1 && envSchema.envPrefix().empty() &&
+            ctx.parseArgs(3, (char**)argSet, envSchema, (char**)envSet) == app::config::ParseResult::Parsed &&
+            ctx.getString("output-dir") == "/cli" && std::get<int32_t>(ctx.getValue("level")) == 5 &&
+            std::get<int32_t>(ctx.getValue("threads")) == 4 && ctx.hasValue("verbose") &&
+            std::get<std::vector<int32_t>>(ctx.getValueRef("port")) == std::vector<int32_t>{ 80, 443 }) {
+            nRet = EXIT_SUCCESS;
+        }
+        if (nRet == EXIT_SUCCESS && (ctx.parseArgs(3, (char**)argSet, envSchema, (char**)badEnvSet) != app::config::ParseResult::Error ||
+            ctx.badArgumentIndex != 1)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+        // a flag variable is a boolean, an empty value leaves the flag unset
+        const char* flagOffSet[]{ "GOPT_VERBOSE=0", nullptr };
+        const char* flagEmptySet[]{ "GOPT_VERBOSE=", nullptr };
+        const char* flagOnSet[]{ "GOPT_VERBOSE=On", nullptr };
+        const char* flagBadSet[]{ "GOPT_VERBOSE=maybe", nullptr };
+        if (nRet == EXIT_SUCCESS && (ctx.parseArgs(3, (char**)argSet, envSchema, (char**)flagOffSet) != app::config::ParseResult::Parsed ||
+            ctx.hasValue("verbose") ||
+            ctx.parseArgs(3, (char**)argSet, envSchema, (char**)flagEmptySet) != app::config::ParseResult::Parsed || ctx.hasValue("verbose") ||
+            ctx.parseArgs(3, (char**)argSet, envSchema, (char**)flagOnSet) != app::config::ParseResult::Parsed || !ctx.hasValue("verbose") ||
+            ctx.parseArgs(3, (char**)argSet, envSchema, (char**)flagBadSet) != app::config::ParseResult::Error ||
+            ctx.errorKind != app::config::ErrorKind::BadValue || ctx.badArgumentIndex != 0)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+        // a snapshot key changes with the values of the schema variables only
+        const char* changedEnvSet[]{ "PATH=/bin", "GOPT_OUTPUT_DIR=/env", "GOPT_VERBOSE=1", "GOPT_LEVEL=9", "LOG_LEVEL=6",
+            "GOPT_PORT=80,443", "GOPT_UNKNOWN=1", "GOPT", nullptr };
+        const char* otherEnvSet[]{ "PATH=/usr/bin", "GOPT_OUTPUT_DIR=/env", "GOPT_VERBOSE=1", "GOPT_LEVEL=9", "LOG_LEVEL=5",
+            "GOPT_PORT=80,443", "GOPT_UNKNOWN=2", "GOPT", nullptr };
+        const std::string path = (std::filesystem::temp_directory_path() / "getOptPlusPlus_test_env.snapshot").string();
+        const uint64_t key = app::config::Snapshot::makeKey(envSchema, ctx, 3, (char**)argSet, std::string(), (char**)envSet);
+        app::config::Snapshot snapshot;
+        app::config::ParseContext restored;
+        if (nRet == EXIT_SUCCESS && (ctx.parseArgs(3, (char**)argSet, envSchema, (char**)envSet) != app::config::ParseResult::Parsed ||
+            !app::config::Snapshot::save(path, key, ctx) ||
+            snapshot.load(path, app::config::Snapshot::makeKey(envSchema, ctx, 3, (char**)argSet, std::string(), (char**)changedEnvSet),
+                envSchema, restored) ||
+            !snapshot.load(path, app::config::Snapshot::makeKey(envSchema, ctx, 3, (char**)argSet, std::string(), (char**)otherEnvSet),
+                envSchema, restored) || std::get<int32_t>(restored.getValue("level")) != 5)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+        std::filesystem::remove(path);
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 25;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // readers never see a half-built configuration while it is reloaded
+        const app::arguments::ParserSchema liveSchema(std::vector<app::arguments::Options>{
+            app::arguments::Options('l', "level", "level", app::arguments::Type::Mandatory, app::arguments::ValueType::Int32),
+            app::arguments::Options('m', "mirror", "level copy", app::arguments::Type::Mandatory, app::arguments::ValueType::Int32),
+            app::arguments::Options('n', "name", "level name", app::arguments::Type::Mandatory, app::arguments::ValueType::String),
+        });
+        const std::filesystem::path livePath = std::filesystem::temp_directory_path() / "getOptPlusPlus_live.conf";
+        const auto writeConf = [&livePath](int level) {
+            const std::filesystem::path tmpPath = livePath.string() + ".tmp";
+            {
+                std::ofstream out(tmpPath, std::ios::trunc);
+                out << "level = " << level << "\nmirror = " << level << "\nname = gen " << level << "\n";
+            }
+            std::filesystem::rename(tmpPath, livePath);
+        };
+        const char* liveSet[]{ "program1" };
+        writeConf(0);
+        app::config::LiveConfig live(liveSchema);
+        std::atomic<bool> stopReaders(false);
+        std::atomic<size_t> torn(0);
+        std::atomic<size_t> reads(0);
+        nRet = live.load(1, (char**)liveSet, livePath.string()) == app::config::ParseResult::Parsed ? EXIT_SUCCESS : EXIT_FAILURE;
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 4 && nRet == EXIT_SUCCESS; t++) {
+            readers.emplace_back([&live, &stopReaders, &torn, &reads]() {
+                app::config::LiveConfig::Reader reader = live.reader();
+                while (!stopReaders.load(std::memory_order_relaxed)) {
+                    app::config::LiveConfig::ReadGuard cfg = reader.acquire();
+                    const int32_t level = std::get<int32_t>(cfg->getValueRef("level"));
+                    if (std::get<int32_t>(cfg->getValueRef("mirror")) != level || cfg->getString("name") != "gen " + std::to_string(level)) {
+                        torn ++;
+                    }
+                    reads ++;
+                }
+            });
+        }
+        for (int level = 1; level <= 300 && nRet == EXIT_SUCCESS; level++) {
+            writeConf(level);
+            if (live.reload() != app::config::ParseResult::Parsed) {
+                nRet = EXIT_DIFF_TYPE;
+            }
+        }
+        stopReaders = true;
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        if (nRet == EXIT_SUCCESS && (torn != 0 || reads == 0 || live.published() != 301)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+        if (nRet == EXIT_SUCCESS && live.watch()) {
+            // the watcher thread reloads on rename
+            writeConf(1000);
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            app::config::LiveConfig::Reader reader = live.reader();
+            while (std::get<int32_t>(reader.acquire()->getValueRef("level")) != 1000 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            if (std::get<int32_t>(reader.acquire()->getValueRef("level")) != 1000) {
+                nRet = EXIT_DIFF_TYPE;
+            }
+            live.stop();
+        }
+        std::filesystem::remove(livePath);
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 26;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // --name=value and -Ovalue
+        const app::arguments::ParserSchema eqSchema(std::vector<app::arguments::Options>{
+            app::arguments::Options('p', "probability", "probability", app::arguments::Type::Mandatory, app::arguments::ValueType::Float),
+            app::arguments::Options('O', "output", "output directory", app::arguments::Type::Mandatory, app::arguments::ValueType::String),
+            app::arguments::Options('l', "level", "level", app::arguments::Type::Optional, app::arguments::ValueType::Int32),
+            app::arguments::Options('v', "verbose", "verbose output"),
+        });
+        const char* eqSet[]{ "program1", "--probability=0.7", "-O/tmp/a=b", "-vl5" };
+        const char* prefixSet[]{ "program1", "--prob=0.25", "--output=", "-level=3" };
+        const char* flagSet[]{ "program1", "--verbose=1" };
+        app::config::ParseContext ctx;
+        nRet = EXIT_FAILURE;
+        if (ctx.parseArgs(4, (char**)eqSet, eqSchema) == app::config::ParseResult::Parsed &&
+            std::get<double>(ctx.getValue("probability")) == 0.7 && ctx.getString("output") == "/tmp/a=b" &&
+            ctx.hasValue("verbose") && std::get<int32_t>(ctx.getValue("level")) == 5) {
+            nRet = EXIT_SUCCESS;
+        }
+        ctx.setAbbreviations(true);
+        ctx.setLongOnly(true);
+        if (nRet == EXIT_SUCCESS && (ctx.parseArgs(4, (char**)prefixSet, eqSchema) != app::config::ParseResult::Parsed ||
+            std::get<double>(ctx.getValue("probability")) != 0.25 || !ctx.getString("output").empty() ||
+            std::get<int32_t>(ctx.getValue("level")) != 3)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+        if (nRet == EXIT_SUCCESS && (ctx.parseArgs(2, (char**)flagSet, eqSchema) != app::config::ParseResult::Error || ctx.badArgumentIndex != 1)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 27;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // UTF-8 validation, multi-byte short options and wide character arguments
+        std::vector<app::arguments::Options> utfOpts{
+            app::arguments::Options(' ', "lambda", "a flag"),
+            app::arguments::Options('O', "output", "output directory", app::arguments::Type::Mandatory, app::arguments::ValueType::String),
+            app::arguments::Options('v', "verbose", "verbose output"),
+        };
+        utfOpts[0].shortUtf8 = "\xce\xbb"; // U+03BB
+        const app::arguments::ParserSchema utfSchema(utfOpts);
+        const std::string longPath = "/tmp/" + std::string(40, 'a') + "\xe6\x97\xa5\xe6\x9c\xac/\xf0\x9f\x98\x80";
+        const char* utfSet[]{ "program1", "-v\xce\xbb", "-O", longPath.c_str() };
+        const char* truncatedSet[]{ "program1", "-O", "caf\xc3" };
+        const std::string badPath = std::string(37, 'x') + "\xed\xa0\x80"; // encoded surrogate after a SIMD block
+        const char* surrogateSet[]{ "program1", "-O", badPath.c_str() };
+        const char* overlongSet[]{ "program1", "--output=\xc0\xaf" };
+        const wchar_t* wideSet[]{ L"program1", L"-\u03bb", L"--output=/tmp/\u65e5\u672c" };
+        const wchar_t badWide[]{ L'-', L'O', static_cast<wchar_t>(0xd800), L'\0' };
+        const wchar_t* badWideSet[]{ L"program1", badWide };
+        const wchar_t* nullWideSet[]{ L"program1", L"-v", nullptr };
+        app::config::ParseContext ctx;
+        ctx.setUtf8Validation(true);
+        nRet = EXIT_FAILURE;
+        if (ctx.parseArgs(4, (char**)utfSet, utfSchema) == app::config::ParseResult::Parsed && ctx.hasValue("lambda") &&
+            ctx.hasValue("verbose") && ctx.getString("output") == longPath) {
+            nRet = EXIT_SUCCESS;
+        }
+        if (nRet == EXIT_SUCCESS && (ctx.parseArgs(3, (char**)truncatedSet, utfSchema) != app::config::ParseResult::BadEncoding ||
+            ctx.badArgumentIndex != 2 || ctx.badArgumentOffset != 3 ||
+            ctx.parseArgs(3, (char**)surrogateSet, utfSchema) != app::config::ParseResult::BadEncoding || ctx.badArgumentOffset != 37 ||
+            ctx.parseArgs(2, (char**)overlongSet, utfSchema) != app::config::ParseResult::BadEncoding || ctx.badArgumentOffset != 9)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+        if (nRet == EXIT_SUCCESS && (ctx.parseArgs(3, (wchar_t**)wideSet, utfSchema) != app::config::ParseResult::Parsed ||
+            !ctx.hasValue("lambda") || ctx.getString("output") != "/tmp/\xe6\x97\xa5\xe6\x9c\xac" ||
+            ctx.parseArgs(2, (wchar_t**)badWideSet, utfSchema) != app::config::ParseResult::BadEncoding ||
+            ctx.badArgumentIndex != 1 || ctx.badArgumentOffset != 2 ||
+            ctx.parseArgs(3, (wchar_t**)nullWideSet, utfSchema) != app::config::ParseResult::Error ||
+            ctx.errorKind != app::config::ErrorKind::NullArgument || ctx.badArgumentIndex != 2)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+        // invalid sequences around the 16 and 32-byte blocks of the vectorized validation
+        const std::string cyrillic = "\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82"; // 12 bytes
+        std::string longText;
+        while (longText.size() < 120) {
+            longText += cyrillic + "\xe6\x97\xa5\xf0\x9f\x98\x80";
+        }
+        if (nRet == EXIT_SUCCESS && app::arguments::validateUtf8(longText) != app::arguments::UTF8_VALID) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+        const char* const badSequences[]{ "\xd0", "\xe6\x97", "\xf0\x9f\x98", "\x9f", "\xc0\xaf", "\xed\xa0\x80",
+            "\xf4\x90\x80\x80", "\xf5\x80\x80\x80", "\xe0\x80\x80", "\xf0\x80\x80\x80", "\xff" };
+        for (size_t position = 10; nRet == EXIT_SUCCESS && position < 100; position++) {
+            size_t offset = position;
+            while ((static_cast<unsigned char>(longText[offset]) & 0xc0) == 0x80) {
+                offset--; // the inserted sequence starts at a character boundary
+            }
+            for (const char* bad : badSequences) {
+                std::string text = longText;
+                text.insert(offset, bad);
+                if (app::arguments::validateUtf8(text) != offset) {
+                    nRet = EXIT_DIFF_TYPE;
+                }
+                text.resize(offset + std::strlen(bad)); // truncated or invalid at the end of the text
+                if (app::arguments::validateUtf8(text) != offset) {
+                    nRet = EXIT_DIFF_TYPE;
+                }
+            }
+        }
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 28;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // streamed arguments
+        const app::arguments::ParserSchema streamSchema(std::vector<app::arguments::Options>{
+            app::arguments::Options('O', "output", "output directory", app::arguments::Type::Mandatory, app::arguments::ValueType::String),
+            app::arguments::Options('l', "level", "level", app::arguments::Type::Optional, app::arguments::ValueType::Int32),
+            app::arguments::Options('v', "verbose", "verbose output"),
+        });
+        app::config::ParseContext ctx;
+        nRet = EXIT_FAILURE;
+        if (ctx.feed("-v") == app::config::ParseResult::None) {
+            ctx.reset(streamSchema);
+            if (ctx.beginArgs() == app::config::ParseResult::Parsed && ctx.feed("-vO") == app::config::ParseResult::Parsed &&
+                ctx.isAwaitingValue() && ctx.feed("/tmp") == app::config::ParseResult::Parsed && !ctx.isAwaitingValue() &&
+                ctx.feed("--level") == app::config::ParseResult::Parsed && ctx.isAwaitingValue() &&
+                ctx.finish() == app::config::ParseResult::Parsed && ctx.getString("output") == "/tmp" &&
+                std::get<bool>(ctx.getValue("level")) && ctx.hasValue("verbose")) {
+                nRet = EXIT_SUCCESS;
+            }
+        }
+        // rejected at the first bad argument
+        ctx.reset(streamSchema);
+        ctx.beginArgs();
+        if (nRet == EXIT_SUCCESS && (ctx.feed("-v") != app::config::ParseResult::Parsed ||
+            ctx.feed("--bogus") != app::config::ParseResult::BadOptionIndex || ctx.badArgumentIndex != 2 ||
+            ctx.feed("-v") != app::config::ParseResult::BadOptionIndex || ctx.finish() != app::config::ParseResult::BadOptionIndex)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+        // a mandatory value missing at the end of the stream and arguments after "--"
+        ctx.reset(streamSchema);
+        ctx.beginArgs();
+        if (nRet == EXIT_SUCCESS && (ctx.feed("-v") != app::config::ParseResult::Parsed || ctx.feed("-O") != app::config::ParseResult::Parsed ||
+            ctx.finish() != app::config::ParseResult::Error || ctx.badArgumentIndex != 2)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+        ctx.reset(streamSchema);
+        ctx.beginArgs();
+        if (nRet == EXIT_SUCCESS && (ctx.feed("-l") != app::config::ParseResult::Parsed || ctx.feed("--") != app::config::ParseResult::Parsed ||
+            ctx.feed("--unknown") != app::config::ParseResult::Parsed || ctx.finish() != app::config::ParseResult::Parsed ||
+            ctx.lastParsed != 2 || !std::get<bool>(ctx.getValue("level")) || ctx.feed("-v") != app::config::ParseResult::None)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 29;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // command strings with POSIX shell quoting
+        const app::arguments::ParserSchema cmdSchema(std::vector<app::arguments::Options>{
+            app::arguments::Options('O', "output", "output directory", app::arguments::Type::Mandatory, app::arguments::ValueType::String),
+            app::arguments::Options('l', "level", "level", app::arguments::Type::Optional, app::arguments::ValueType::Int32),
+            app::arguments::Options('v', "verbose", "verbose output"),
+        });
+        std::string quoted = "  a\\\\ b 'c \\ \"d'\"e \\$ \\x \\\n f\"g\\ h \\\n i''  # comment\n\"\" j";
+        app::config::CommandString cmd;
+        nRet = EXIT_FAILURE;
+        if (cmd.split(quoted) == app::config::CommandString::Result::Split && cmd.argc() == 6 &&
+            strcmp(cmd.argv()[0], "a\\") == 0 && strcmp(cmd.argv()[1], "b") == 0 &&
+            strcmp(cmd.argv()[2], "c \\ \"de $ \\x  fg h") == 0 && strcmp(cmd.argv()[3], "i") == 0 &&
+            cmd.argv()[4][0] == '\0' && strcmp(cmd.argv()[5], "j") == 0 && cmd.argv()[6] == nullptr &&
+            cmd.offsetOf(1) == 6 && cmd.offsetOf(6) == std::string::npos) {
+            nRet = EXIT_SUCCESS;
+        }
+        std::string unterminated = "-v \"-O 'x'";
+        std::string args = "-l 3";
+        if (nRet == EXIT_SUCCESS && (cmd.split(unterminated) != app::config::CommandString::Result::Unterminated ||
+            cmd.badArgumentIndex != 1 || cmd.badArgumentOffset != 3 || cmd.argc() != 0 ||
+            cmd.split(args, "program1") != app::config::CommandString::Result::Split || cmd.argc() != 3 ||
+            strcmp(cmd.argv()[0], "program1") != 0 || cmd.offsetOf(0) != std::string::npos || cmd.offsetOf(2) != 3)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+        app::config::ParseContext ctx;
+        std::string line = "program1 -v --output '/tmp/my dir' -l\"4\"2";
+        std::string badLine = "program1 -v -O 'x";
+        if (nRet == EXIT_SUCCESS && (ctx.parseCommand(line, cmdSchema) != app::config::ParseResult::Parsed ||
+            ctx.getString("output") != "/tmp/my dir" || std::get<int32_t>(ctx.getValue("level")) != 42 || !ctx.hasValue("verbose") ||
+            ctx.parseCommand(badLine, cmdSchema) != app::config::ParseResult::Error ||
+            ctx.badArgumentIndex != 3 || ctx.badArgumentOffset != 15)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 30;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // subcommands with lazily built schemas
+        static int builds = 0;
+        static const app::config::Subcommand commands[] = {
+            { "push", "updates remote refs", []() {
+                builds ++;
+                return std::vector<app::arguments::Options>{
+                    app::arguments::Options('f', "force", "force update"),
+                    app::arguments::Options('r', "remote", "remote name", app::arguments::Type::Mandatory, app::arguments::ValueType::String),
+                };
+            } },
+            { "commit", "records changes", []() {
+                builds ++;
+                return std::vector<app::arguments::Options>{
+                    app::arguments::Options('m', "message", "commit message", app::arguments::Type::Mandatory, app::arguments::ValueType::String),
+                };
+            } },
+        };
+        const app::config::Subcommands subcommands(commands);
+        const app::arguments::ParserSchema globalSchema(std::vector<app::arguments::Options>{
+            app::arguments::Options('C', "directory", "working directory", app::arguments::Type::Mandatory, app::arguments::ValueType::String),
+            app::arguments::Options('v', "verbose", "verbose output"),
+        });
+        const char* pushSet[]{ "program1", "-C", "/src", "-v", "push", "-f", "--remote", "origin" };
+        const char* unknownSet[]{ "program1", "-v", "pull" };
+        const char* badSet[]{ "program1", "commit", "--amend" };
+        const char* noneSet[]{ "program1", "-v" };
+        app::config::ParseContext global;
+        app::config::ParseContext command;
+        size_t idx = 0;
+        std::ostringstream help;
+        subcommands.printHelp(globalSchema.options(), "program1", help);
+        nRet = EXIT_FAILURE;
+        if (builds == 0 && help.str().find("commit  records changes") != std::string::npos &&
+            help.str().find("--directory") != std::string::npos && subcommands.find("pull") == app::config::Subcommands::npos &&
+            subcommands.parse(8, (char**)pushSet, globalSchema, global, command, idx) == app::config::ParseResult::Parsed &&
+            idx == 0 && builds == 1 && !subcommands.isBuilt(1) && global.getString("directory") == "/src" && global.hasValue("verbose") &&
+            command.hasValue("force") && command.getString("remote") == "origin" && !global.getStopAtOperand()) {
+            nRet = EXIT_SUCCESS;
+        }
+        if (nRet == EXIT_SUCCESS && (subcommands.parse(3, (char**)unknownSet, globalSchema, global, command, idx) != app::config::ParseResult::Unknown ||
+            idx != app::config::Subcommands::npos || global.badArgumentIndex != 2 ||
+            subcommands.parse(3, (char**)badSet, globalSchema, global, command, idx) != app::config::ParseResult::BadOptionIndex ||
+            idx != 1 || command.badArgumentIndex != 2 || builds != 2 ||
+            subcommands.parse(2, (char**)noneSet, globalSchema, global, command, idx) != app::config::ParseResult::Parsed ||
+            idx != app::config::Subcommands::npos)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+        std::ostringstream pushHelp;
+        subcommands.printHelp(0, "program1", pushHelp);
+        if (nRet == EXIT_SUCCESS && (pushHelp.str().find("push [options]") == std::string::npos || builds != 2)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 31;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // enumerations and ranges
+        std::vector<app::arguments::Options> rangeOpts{
+            app::arguments::Options('m', "mode", "processing mode", app::arguments::Type::Mandatory, { "fast", "safe", "debug" }, app::arguments::DefaultValue("safe")),
+            app::arguments::Options('p', "probability", "probability", app::arguments::Type::Optional, app::arguments::ValueType::Float),
+            app::arguments::Options('l', "level", "level", app::arguments::Type::Optional, app::arguments::ValueType::Int64),
+            app::arguments::Options('L', "limits", "limits", app::arguments::Type::Optional, app::arguments::ValueType::Int32List),
+        };
+        rangeOpts[1].minValue = 0.0;
+        rangeOpts[1].maxValue = 1.0;
+        rangeOpts[2].minValue = int32_t(1);
+        rangeOpts[2].maxValue = int64_t(10);
+        rangeOpts[3].maxValue = int32_t(100);
+        const app::arguments::ParserSchema rangeSchema(rangeOpts);
+        const char* goodSet[]{ "program1", "--mode", "debug", "-p", "1", "-l", "10", "-L", "1,100", "-L", "0" };
+        const char* defaultSet[]{ "program1", "-p", "0" };
+        const char* badSets[][3]{ { "program1", "--mode", "turbo" }, { "program1", "-p", "1.5" }, { "program1", "-p", "nan" },
+            { "program1", "-l", "0" }, { "program1", "-L", "1,200" } };
+        const char* appendSet[]{ "program1", "-L", "5", "-L", "500" };
+        app::config::ParseContext ctx;
+        nRet = EXIT_FAILURE;
+        if (ctx.parseArgs(11, (char**)goodSet, rangeSchema) == app::config::ParseResult::Parsed &&
+            std::get<int32_t>(ctx.getValue("mode")) == 2 && std::get<double>(ctx.getValue("probability")) == 1.0 &&
+            std::get<int64_t>(ctx.getValue("level")) == 10 && std::get<std::vector<int32_t>>(ctx.getValue("limits")).size() == 3 &&
+            ctx.parseArgs(3, (char**)defaultSet, rangeSchema) == app::config::ParseResult::Parsed &&
+            std::get<int32_t>(ctx.getValue("mode")) == 1) {
+            nRet = EXIT_SUCCESS;
+        }
+        for (const auto& badSet : badSets) {
+            if (nRet == EXIT_SUCCESS && (ctx.parseArgs(3, (char**)badSet, rangeSchema) != app::config::ParseResult::Error ||
+                ctx.badArgumentIndex != 2)) {
+                nRet = EXIT_DIFF_TYPE;
+            }
+        }
+        if (nRet == EXIT_SUCCESS && (ctx.parseArgs(5, (char**)appendSet, rangeSchema) != app::config::ParseResult::Error ||
+            ctx.badArgumentIndex != 4)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+        // every name of a larger enumeration resolves through the perfect hash
+        std::vector<std::string> names;
+        for (int i = 0; i < 200; i++) {
+            names.push_back("name_" + std::to_string(i * 7919));
+        }
+        app::arguments::EnumIndex index;
+        index.build(names);
+        for (size_t i = 0; i < names.size() && nRet == EXIT_SUCCESS; i++) {
+            if (index.find(names[i], names) != static_cast<int32_t>(i)) {
+                nRet = EXIT_DIFF_TYPE;
+            }
+        }
+        if (nRet == EXIT_SUCCESS && (index.find("name_1", names) != -1 || index.find("", names) != -1)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+        std::ostringstream help;
+        app::config::ParseContext::printHelp(rangeOpts, "program1", help);
+        if (nRet == EXIT_SUCCESS && (help.str().find("one of: fast safe debug, default: safe") == std::string::npos ||
+            help.str().find("range: 0..1") == std::string::npos || help.str().find("range: ..100") == std::string::npos)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+        try {
+            app::arguments::Options('m', "mode", "processing mode", app::arguments::Type::Optional, { "fast" }, app::arguments::DefaultValue("slow"));
+            nRet = EXIT_DIFF_TYPE;
+        } catch (const std::invalid_argument&) {
+        }
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
+    testNum = 32;
+    expected = EXIT_SUCCESS;
+    std::cout << "Performing test " << testNum << std::endl;
+    {
+        // the exception-free parse reports the failure reason, index and offset
+        std::vector<app::arguments::Options> kindOpts{
+            app::arguments::Options('n', "number", "a number", app::arguments::Type::Mandatory, app::arguments::ValueType::Int32),
+            app::arguments::Options('o', "optional", "an optional number", app::arguments::Type::Optional, app::arguments::ValueType::Int32),
+            app::arguments::Options('f', "flag", "a flag"),
+            app::arguments::Options('F', "flat", "a flat flag"),
+        };
+        kindOpts[0].minValue = int32_t(1);
+        kindOpts[0].maxValue = int32_t(10);
+        const app::arguments::ParserSchema kindSchema(kindOpts);
+        const char* goodSet[]{ "program1", "-n", "5", "-o", "x", "-f" };
+        const struct {
+            int argc;
+            const char* argv[3];
+            app::config::ParseResult result;
+            app::config::ErrorKind kind;
+            size_t index;
+            size_t offset;
+        } badSets[] = {
+            { 2, { "program1", "--bogus" }, app::config::ParseResult::BadOptionIndex, app::config::ErrorKind::UnknownOption, 1, 0 },
+            { 2, { "program1", "-fz" }, app::config::ParseResult::Unknown, app::config::ErrorKind::UnknownOption, 1, 2 },
+            { 2, { "program1", "--flag=1" }, app::config::ParseResult::Error, app::config::ErrorKind::UnexpectedValue, 1, 0 },
+            { 2, { "program1", "--fla" }, app::config::ParseResult::Ambiguous, app::config::ErrorKind::AmbiguousOption, 1, 0 },
+            { 3, { "program1", "-n", "x" }, app::config::ParseResult::Error, app::config::ErrorKind::BadValue, 2, 0 },
+            { 3, { "program1", "-n", "11" }, app::config::ParseResult::Error, app::config::ErrorKind::OutOfRange, 2, 0 },
+            { 2, { "program1", "-n" }, app::config::ParseResult::Error, app::config::ErrorKind::MissingValue, 1, 0 },
+        };
+        app::config::ParseContext ctx;
+        ctx.setAbbreviations(true);
+        nRet = EXIT_FAILURE;
+        const auto good = ctx.tryParseArgs(6, (char**)goodSet, kindSchema);
+        if (good && good.error().kind == app::config::ErrorKind::None && std::get<int32_t>(ctx.getValue("number")) == 5 &&
+            std::get<bool>(ctx.getValue("optional"))) {
+            nRet = EXIT_SUCCESS;
+        }
+        for (const auto& bad : badSets) {
+            const auto res = ctx.tryParseArgs(bad.argc, (char**)bad.argv, kindSchema);
+            if (nRet == EXIT_SUCCESS && (res.has_value() || res.result() != bad.result || res.error().kind != bad.kind ||
+                res.error().index != bad.index || res.error().offset != bad.offset || ctx.errorKind != bad.kind)) {
+                nRet = EXIT_DIFF_TYPE;
+            }
+        }
+        // the classic parse records the reason too and a successful parse clears it
+        if (nRet == EXIT_SUCCESS && (ctx.parseArgs(6, (char**)goodSet, kindSchema) != app::config::ParseResult::Parsed ||
+            ctx.errorKind != app::config::ErrorKind::None)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+        app::arguments::Value val;
+        if (nRet == EXIT_SUCCESS && (kindOpts[0].tryAcquireValue("11", app::arguments::StringMode::Copy, val) != app::arguments::ConvResult::OutOfRange ||
+            kindOpts[0].tryAcquireValue(nullptr, app::arguments::StringMode::Copy, val) != app::arguments::ConvResult::Missing ||
+            kindOpts[0].tryAcquireValue("7", app::arguments::StringMode::Copy, val) != app::arguments::ConvResult::Ok ||
+            std::get<int32_t>(val) != 7)) {
+            nRet = EXIT_DIFF_TYPE;
+        }
+    }
+    if (nRet == expected) {
+        std::cout << "Test " << testNum << " passed" << std::endl;
+    }
+    else {
+        std::cout << "Test " << testNum << " failed. Expected " << stringTable[expected] << ", actual " << stringTable[nRet] << std::endl;
+        return EXIT_FAILURE;
+    }
     return EXIT_SUCCESS;
 }
 